@@ -0,0 +1,378 @@
+#include "Arena.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+namespace {
+uint64_t mix(uint64_t hash, uint64_t value) {
+    hash ^= value + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+const long long DECIDE_GRAIN = 256;    // Snakes per parallel chunk
+
+int strideShift(int width) {
+    // Room for the boundary column on each side
+    int shift = 2;
+    while ((1 << shift) < width + 2) shift++;
+    return shift;
+}
+}
+
+Arena::Arena(const ArenaConfig& arenaConfig) :
+    config(arenaConfig),
+    width(arenaConfig.width),
+    height(arenaConfig.height),
+    rowShift(strideShift(arenaConfig.width)),
+    sectorColumns((arenaConfig.width + SECTOR_SIZE - 1) / SECTOR_SIZE),
+    graph(arenaConfig.width, arenaConfig.height),
+    levelGenerator(arenaConfig.width, arenaConfig.height),
+    cells(static_cast<size_t>(arenaConfig.height + 2) << strideShift(arenaConfig.width)),
+    snakes(arenaConfig.snakes),
+    targets(arenaConfig.snakes, -1),
+    tailTick(arenaConfig.snakes, 0),
+    deathCause(arenaConfig.snakes, 0),
+    playerSnake(-1),
+    playerDirection(RIGHT),
+    tick(0),
+    totalMicros(0) {
+    config.startLength = std::max(2, config.startLength);
+    offsets[UP] = -(1 << rowShift);
+    offsets[DOWN] = 1 << rowShift;
+    offsets[LEFT] = -1;
+    offsets[RIGHT] = 1;
+    // Sectors on the right and bottom edges may be partial
+    int size = SECTOR_SIZE;
+    for (int top = 0; top < height; top += size) {
+        for (int left = 0; left < width; left += size) {
+            sectors.emplace_back(left, top, std::min(size, width - left), std::min(size, height - top),
+                                 config.foodPerSector);
+        }
+    }
+    sectorStart.assign(sectors.size() + 1, 0);
+    order.reserve(snakes.size());
+    dying.reserve(snakes.size());
+}
+
+void Arena::reset(uint64_t seed) {
+    rng.seed(seed);
+    tick = 0;
+    std::fill(tailTick.begin(), tailTick.end(), 0);
+    stats = ArenaStats();
+    totalMicros = 0;
+
+    levelGenerator.seed(seed ^ 0xA7E4A5EEDULL);
+    levelGenerator.generate(graph, config.wallLevel, config.style);
+    for (Cell& cell : cells) cell = Cell{ ARENA_BOUNDARY, -1 };
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) cells[toCell(x, y)].owner = ARENA_EMPTY;
+    }
+    for (size_t i = 0; i < sectors.size(); i++) {
+        sectors[i].freeCells.fill();
+        sectors[i].food.clear();
+        sectors[i].food.seed(rng.next());
+    }
+    graph.forEachWall([this](int x, int y) {
+        int cell = toCell(x, y);
+        cells[cell].owner = ARENA_WALL;
+        Sector& sector = sectorOf(cell);
+        sector.freeCells.erase(x - sector.left, y - sector.top);
+    });
+
+    // Snakes go down before the food, so no snake starts on top of any
+    for (size_t i = 0; i < snakes.size(); i++) {
+        snakes[i] = ArenaSnake();
+        snakes[i].rng.seed(rng.next());
+        if (!trySpawn(static_cast<int>(i))) snakes[i].respawnIn = 1;
+    }
+    for (Sector& sector : sectors) sector.food.spawnRandom(sector.freeCells);
+    stats.respawns = 0;
+}
+
+bool Arena::passable(int cell) const {
+    int owner = cells[cell].owner;
+    if (owner == ARENA_EMPTY) return true;
+    if (owner < 0) return false;
+    // A tail that is not held for growth moves away this tick
+    return cell == snakes[owner].tail && snakes[owner].growth == 0;
+}
+
+bool Arena::isFree(int cell) const {
+    if (cells[cell].owner != ARENA_EMPTY) return false;
+    // Empty cells can still hold food
+    const Sector& sector = sectorOf(cell);
+    return sector.freeCells.contains(cellX(cell) - sector.left, cellY(cell) - sector.top);
+}
+
+bool Arena::nearOtherHead(int cell, int self) const {
+    // A head is the one body cell without a next link
+    for (int offset : offsets) {
+        const Cell& next = cells[cell + offset];
+        if (next.owner >= 0 && next.owner != self && next.next < 0) return true;
+    }
+    return false;
+}
+
+Direction Arena::choose(int index) {
+    ArenaSnake& snake = snakes[index];
+    Direction reverse = static_cast<Direction>(snake.direction ^ 1);
+    if (index == playerSnake) return playerDirection == reverse ? snake.direction : playerDirection;
+
+    // Nearest food in the head's own sector, by Manhattan distance
+    const Sector& sector = sectorOf(snake.head);
+    int headX = cellX(snake.head) - sector.left;
+    int headY = cellY(snake.head) - sector.top;
+    int foodX = -1, foodY = -1;
+    int nearest = 1 << 30;
+    for (const Position& position : sector.food.getPositions()) {
+        int distance = std::abs(position.x - headX) + std::abs(position.y - headY);
+        if (distance < nearest) {
+            nearest = distance;
+            foodX = position.x + sector.left;
+            foodY = position.y + sector.top;
+        }
+    }
+
+    // Safe moves, best first: away from other heads, then toward the food
+    // (or straight on without any); now and then a random safe move instead
+    Direction options[3];
+    int optionCount = 0;
+    Direction best = snake.direction;
+    int bestCost = 1 << 30;
+    for (int d = UP; d <= RIGHT; d++) {
+        Direction dir = static_cast<Direction>(d);
+        int cell = snake.head + offsets[d];
+        if (dir == reverse || !passable(cell)) continue;
+        options[optionCount++] = dir;
+        int cost = foodX >= 0 ? std::abs(cellX(cell) - foodX) + std::abs(cellY(cell) - foodY) : (dir != snake.direction);
+        cost = cost * 4 + snake.rng.nextBelow(4);
+        if (nearOtherHead(cell, index)) cost += 1 << 20;
+        if (cost < bestCost) {
+            bestCost = cost;
+            best = dir;
+        }
+    }
+    if (optionCount > 1 && snake.rng.nextBelow(16) == 0) best = options[snake.rng.nextBelow(optionCount)];
+    return best;
+}
+
+void Arena::occupy(int cell, int owner) {
+    cells[cell].owner = owner;
+    cells[cell].next = -1;
+    Sector& sector = sectorOf(cell);
+    sector.freeCells.erase(cellX(cell) - sector.left, cellY(cell) - sector.top);
+}
+
+void Arena::release(int cell) {
+    cells[cell].owner = ARENA_EMPTY;
+    cells[cell].next = -1;
+    Sector& sector = sectorOf(cell);
+    sector.freeCells.insert(cellX(cell) - sector.left, cellY(cell) - sector.top);
+}
+
+void Arena::moveTail(int index) {
+    ArenaSnake& snake = snakes[index];
+    tailTick[index] = tick;
+    if (snake.growth > 0) {
+        snake.growth--;
+        return;
+    }
+    int tail = snake.tail;
+    snake.tail = cells[tail].next;
+    release(tail);
+    snake.length--;
+}
+
+void Arena::kill(int index) {
+    // Tail to head along the links; each cell was written once by a move
+    ArenaSnake& snake = snakes[index];
+    for (int cell = snake.tail; cell >= 0;) {
+        int next = cells[cell].next;
+        release(cell);
+        cell = next;
+    }
+    stats.freedCells += snake.length;
+    stats.deaths[deathCause[index]]++;
+    stats.alive--;
+    snake.alive = false;
+    snake.head = snake.tail = -1;
+    snake.respawnIn = std::max(1, config.respawnTicks);
+}
+
+bool Arena::trySpawn(int index) {
+    // A straight body on free cells, facing a free cell
+    ArenaSnake& snake = snakes[index];
+    int length = config.startLength;
+    for (int attempt = 0; attempt < SPAWN_TRIES; attempt++) {
+        Sector& sector = sectors[snake.rng.nextBelow(static_cast<int>(sectors.size()))];
+        if (sector.freeCells.empty()) continue;
+        Position position = sector.freeCells.pick(snake.rng);
+        int head = toCell(position.x + sector.left, position.y + sector.top);
+        Direction dir = static_cast<Direction>(snake.rng.nextBelow(4));
+        Direction back = static_cast<Direction>(dir ^ 1);
+
+        bool fits = isFree(head + offsets[dir]);
+        int tail = head;
+        for (int i = 1; i < length && fits; i++) {
+            tail += offsets[back];
+            fits = isFree(tail);
+        }
+        if (!fits) continue;
+
+        occupy(tail, index);
+        for (int cell = tail; cell != head;) {
+            int next = cell + offsets[dir];
+            cells[cell].next = next;
+            occupy(next, index);
+            cell = next;
+        }
+        snake.head = head;
+        snake.tail = tail;
+        snake.length = length;
+        snake.growth = 0;
+        snake.score = 0;
+        snake.direction = dir;
+        snake.alive = true;
+        stats.respawns++;
+        stats.alive++;
+        return true;
+    }
+    return false;
+}
+
+bool Arena::headOn(int index) const {
+    // Another head next to the target that is entering it too
+    int target = targets[index];
+    for (int offset : offsets) {
+        const Cell& next = cells[target + offset];
+        if (next.owner >= 0 && next.owner != index && next.next < 0 && targets[next.owner] == target) return true;
+    }
+    return false;
+}
+
+void Arena::sortBySector() {
+    // Counting sort of the live snakes by the sector of their head
+    std::fill(sectorStart.begin(), sectorStart.end(), 0);
+    int live = 0;
+    for (const ArenaSnake& snake : snakes) {
+        if (!snake.alive) continue;
+        sectorStart[sectorIndex(snake.head) + 1]++;
+        live++;
+    }
+    for (size_t i = 1; i < sectorStart.size(); i++) sectorStart[i] += sectorStart[i - 1];
+    order.resize(live);
+    for (size_t i = 0; i < snakes.size(); i++) {
+        if (snakes[i].alive) order[sectorStart[sectorIndex(snakes[i].head)]++] = static_cast<int32_t>(i);
+    }
+}
+
+void Arena::step(WorkStealingPool* pool) {
+    auto started = std::chrono::steady_clock::now();
+    tick++;
+    sortBySector();
+    long long live = static_cast<long long>(order.size());
+
+    // Moves only read the grid, so snakes can choose in parallel
+    auto decide = [this](long long slot, int) {
+        int index = order[slot];
+        ArenaSnake& snake = snakes[index];
+        snake.direction = choose(index);
+        targets[index] = snake.head + offsets[snake.direction];
+    };
+    if (pool && pool->getThreadCount() > 1) {
+        pool->parallelFor(live, DECIDE_GRAIN, decide);
+    } else {
+        for (long long slot = 0; slot < live; slot++) decide(slot, 0);
+    }
+
+    // Collisions against the grid as it was before anyone moved
+    dying.clear();
+    for (int index : order) {
+        int target = targets[index];
+        int cause = -1;
+        if (cells[target].owner == ARENA_BOUNDARY) {
+            cause = ARENA_DEATH_BOUNDARY;
+        } else if (cells[target].owner == ARENA_WALL) {
+            cause = ARENA_DEATH_WALL;
+        } else if (!passable(target)) {
+            cause = cells[target].owner == index ? ARENA_DEATH_SELF : ARENA_DEATH_BODY;
+        } else if (headOn(index)) {
+            cause = ARENA_DEATH_HEAD_ON;
+        }
+        if (cause >= 0) {
+            deathCause[index] = static_cast<uint8_t>(cause);
+            dying.push_back(index);
+        }
+    }
+
+    // Dead bodies first, then each snake's tail and head in one pass. A head
+    // entering a tail that has not moved yet moves that tail first.
+    for (int index : dying) kill(index);
+    int longest = 0;
+    for (int index : order) {
+        ArenaSnake& snake = snakes[index];
+        if (!snake.alive) continue;
+        if (tailTick[index] != tick) moveTail(index);
+        int target = targets[index];
+        int owner = cells[target].owner;
+        if (owner >= 0) moveTail(owner);
+        cells[snake.head].next = target;
+        occupy(target, index);
+        snake.head = target;
+        snake.length++;
+        stats.moves++;
+
+        Sector& sector = sectorOf(target);
+        if (sector.food.checkCollision(cellX(target) - sector.left, cellY(target) - sector.top)) {
+            snake.growth++;
+            snake.score += POINTS_PER_FOOD;
+            stats.eaten++;
+            sector.food.spawnRandom(sector.freeCells);
+        }
+        longest = std::max(longest, snake.length);
+    }
+    stats.longest = longest;
+
+    // Respawns last, so a new body never lands on a cell a head just took
+    for (size_t i = 0; i < snakes.size(); i++) {
+        ArenaSnake& snake = snakes[i];
+        if (!snake.alive && --snake.respawnIn <= 0 && !trySpawn(static_cast<int>(i))) snake.respawnIn = 1;
+    }
+    stats.ticks++;
+
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - started).count();
+    totalMicros += micros;
+    stats.lastTickMicros = micros;
+    stats.averageTickMicros = totalMicros / stats.ticks;
+    stats.maxTickMicros = std::max(stats.maxTickMicros, micros);
+}
+
+bool Arena::hasFood(int x, int y) const {
+    if (x < 0 || x >= width || y < 0 || y >= height) return false;
+    const Sector& sector = sectorOf(toCell(x, y));
+    return sector.food.contains(x - sector.left, y - sector.top);
+}
+
+int Arena::getFoodCount() const {
+    int count = 0;
+    for (const Sector& sector : sectors) count += sector.food.getCount();
+    return count;
+}
+
+uint64_t Arena::getStateHash() const {
+    uint64_t hash = mix(tick, graph.getLayoutHash());
+    for (const ArenaSnake& snake : snakes) {
+        hash = mix(hash, snake.alive);
+        hash = mix(hash, static_cast<uint32_t>(snake.head));
+        hash = mix(hash, static_cast<uint32_t>(snake.tail));
+        hash = mix(hash, static_cast<uint64_t>(snake.length));
+        hash = mix(hash, static_cast<uint64_t>(snake.score));
+    }
+    for (const Sector& sector : sectors) {
+        for (const Position& position : sector.food.getPositions()) {
+            hash = mix(hash, static_cast<uint64_t>(position.y + sector.top) * width + position.x + sector.left);
+        }
+    }
+    return hash;
+}
@@ -0,0 +1,168 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <vector>
+#include <cstdint>
+#include "Graph.h"
+#include "Food.h"
+#include "FreeCellSet.h"
+#include "LevelGenerator.h"
+#include "Random.h"
+#include "Snake.h"
+
+class WorkStealingPool;
+
+enum ArenaDeath { ARENA_DEATH_BOUNDARY, ARENA_DEATH_WALL, ARENA_DEATH_SELF, ARENA_DEATH_BODY, ARENA_DEATH_HEAD_ON,
+                  ARENA_DEATH_COUNT };
+
+struct ArenaConfig {
+    int width = 256, height = 256;
+    int snakes = 200;
+    int startLength = 3;            // At least 2
+    int foodPerSector = 6;          // Food items kept in each SECTOR_SIZE square
+    int respawnTicks = 10;          // Wait after a death before the snake re-enters
+    LevelStyle style = LEVEL_RANDOM;
+    int wallLevel = 2;
+};
+
+struct ArenaStats {
+    unsigned long long ticks = 0;
+    unsigned long long moves = 0;           // Heads pushed, the cells the ticks moved
+    unsigned long long freedCells = 0;      // Body cells cleared after deaths
+    unsigned long long eaten = 0;
+    unsigned long long respawns = 0;
+    unsigned long long deaths[ARENA_DEATH_COUNT] = {};
+    int alive = 0;
+    int longest = 0;
+    double lastTickMicros = 0;
+    double averageTickMicros = 0;
+    double maxTickMicros = 0;
+};
+
+struct ArenaSnake {
+    int32_t head = -1, tail = -1;   // Grid cells; Arena::cellX()/cellY() give coordinates
+    int length = 0;
+    int growth = 0;                 // Ticks left with the tail held in place
+    int score = 0;
+    int respawnIn = 0;
+    Direction direction = RIGHT;
+    bool alive = false;
+    Random rng;
+};
+
+// Hundreds to thousands of snakes on one board. Every cell has an owner in
+// a shared grid (a snake index, ARENA_EMPTY, ARENA_WALL or ARENA_BOUNDARY)
+// and a link to the next body cell toward the head, so each body is a list
+// threaded through the grid: a move writes two cells and a snake needs no
+// storage of its own. Rows are a power of two wide and the board has a ring
+// of boundary cells around it, so a neighbour is one add and a cell's
+// coordinates are a mask and a shift.
+//
+// A tick decides every snake's move, then resolves collisions from the grid
+// alone. Two heads entering the same cell must be next to it, so a head-on
+// collision is found by looking at the cell's four neighbours; both snakes
+// die. A cell owned by any snake kills the head entering it, unless it is a
+// tail that moves away this tick. All moves are then applied at once, so
+// collisions do not depend on snake order. The work is O(snakes moved), plus
+// each dead body's cells once, never O(snakes^2) or O(board). Snakes are
+// visited grouped by sector (a counting sort per tick), so neighbouring
+// snakes share cache lines of the grid instead of each missing on its own.
+//
+// Food and free cells are bucketed by SECTOR_SIZE squares, each with its own
+// Food and FreeCellSet in local coordinates. Eating, respawning food and
+// looking for the nearest food only touch one sector's short list, so their
+// cost does not grow with the board or the snake count. Food is shared: the
+// first head to reach it takes it, and the sector tops itself back up.
+class Arena {
+private:
+    struct Cell {
+        int32_t owner;
+        int32_t next;           // Next body cell toward the head, -1 at the head
+    };
+    struct Sector {
+        int left, top;
+        FreeCellSet freeCells;
+        Food food;
+        Sector(int left, int top, int width, int height, int maxFood) :
+            left(left), top(top), freeCells(width, height), food(maxFood, width, height) {}
+    };
+
+    ArenaConfig config;
+    int width, height;
+    int rowShift;                   // Grid row stride is 1 << rowShift
+    int offsets[4];                 // Cell step per Direction
+    int sectorColumns;
+    Graph graph;
+    LevelGenerator levelGenerator;
+    std::vector<Cell> cells;
+    std::vector<Sector> sectors;
+    std::vector<ArenaSnake> snakes;
+    std::vector<int32_t> targets;   // Per snake, the cell entered this tick
+    std::vector<uint32_t> tailTick; // Tick each snake's tail last moved
+    std::vector<int32_t> order;     // Live snakes grouped by the sector of their head
+    std::vector<int32_t> sectorStart;
+    std::vector<int32_t> dying;
+    std::vector<uint8_t> deathCause;
+    int playerSnake;
+    Direction playerDirection;
+    uint32_t tick;
+    Random rng;
+    ArenaStats stats;
+    double totalMicros;
+
+    static const int SECTOR_SHIFT = 5;
+    static const int SECTOR_SIZE = 1 << SECTOR_SHIFT;
+    static const int POINTS_PER_FOOD = 10;
+    static const int SPAWN_TRIES = 8;
+
+    bool passable(int cell) const;
+    bool isFree(int cell) const;
+    int toCell(int x, int y) const { return ((y + 1) << rowShift) | (x + 1); }
+    int sectorIndex(int cell) const { return (cellY(cell) >> SECTOR_SHIFT) * sectorColumns + (cellX(cell) >> SECTOR_SHIFT); }
+    Sector& sectorOf(int cell) { return sectors[sectorIndex(cell)]; }
+    const Sector& sectorOf(int cell) const { return sectors[sectorIndex(cell)]; }
+    bool nearOtherHead(int cell, int self) const;
+    bool headOn(int index) const;
+    void sortBySector();
+    Direction choose(int index);
+    void occupy(int cell, int owner);
+    void release(int cell);
+    void moveTail(int index);
+    void kill(int index);
+    bool trySpawn(int index);
+
+public:
+    static const int32_t ARENA_EMPTY = -1;
+    static const int32_t ARENA_WALL = -2;
+    static const int32_t ARENA_BOUNDARY = -3;
+
+    explicit Arena(const ArenaConfig& config);
+    // New walls, food and snakes; the same seed gives the same arena
+    void reset(uint64_t seed);
+    // Wall layout used from the next reset() on
+    void setLevelStyle(LevelStyle style) { config.style = style; }
+    // One tick for every snake. With a pool the moves are chosen in
+    // parallel; the result is the same for any thread count.
+    void step(WorkStealingPool* pool = nullptr);
+
+    // The player's snake takes its moves from setPlayerDirection(); -1 for none
+    void setPlayerSnake(int index) { playerSnake = index; }
+    void setPlayerDirection(Direction dir) { playerDirection = dir; }
+    int getPlayerSnake() const { return playerSnake; }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    const Graph& getGraph() const { return graph; }
+    int cellX(int cell) const { return (cell & ((1 << rowShift) - 1)) - 1; }
+    int cellY(int cell) const { return (cell >> rowShift) - 1; }
+    // Snake index at (x, y), ARENA_EMPTY or ARENA_WALL
+    int getOwner(int x, int y) const { return cells[toCell(x, y)].owner; }
+    bool hasFood(int x, int y) const;
+    int getFoodCount() const;
+    const std::vector<ArenaSnake>& getSnakes() const { return snakes; }
+    const ArenaStats& getStats() const { return stats; }
+    uint32_t getTick() const { return tick; }
+    uint64_t getStateHash() const;
+};
+
+#endif
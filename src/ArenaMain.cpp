@@ -0,0 +1,192 @@
+#include "Arena.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Headless many-snake arena: runs hundreds to thousands of AI snakes on one
+// board and reports tick cost, deaths by cause and the leaders.
+//   snake_arena [--snakes N] [--grid WxH] [--ticks T] [--threads N]
+//               [--style name] [--food N] [--seed S] [--scaling]
+// Without --grid the board grows with the snake count (CELLS_PER_SNAKE
+// cells each). --scaling runs 125, 250, 500 .. N snakes at that density to
+// show the cost per moved cell staying flat. With more than one thread the
+// run is repeated on one thread and must end in the same state.
+
+namespace {
+const int CELLS_PER_SNAKE = 256;
+const int AUTO_GRID_STEP = 32;          // Auto-sized boards are whole sectors
+
+struct Options {
+    int snakes = 1000;
+    int width = 0, height = 0;          // 0: sized from the snake count
+    long long ticks = 2000;
+    int threads = 1;
+    LevelStyle style = LEVEL_RANDOM;
+    int foodPerSector = 6;
+    uint64_t seed = 1;
+    bool scaling = false;
+};
+
+struct RunResult {
+    ArenaStats stats;
+    double setupMillis = 0;
+    double seconds = 0;
+    double averageAlive = 0;
+    uint64_t hash = 0;
+    std::vector<int> topScores;
+    int width = 0, height = 0;
+};
+
+ArenaConfig configFor(const Options& options, int snakes) {
+    ArenaConfig config;
+    config.snakes = snakes;
+    config.style = options.style;
+    config.foodPerSector = options.foodPerSector;
+    if (options.width > 0) {
+        config.width = options.width;
+        config.height = options.height;
+    } else {
+        int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(snakes) * CELLS_PER_SNAKE)));
+        side = std::max(64, (side + AUTO_GRID_STEP - 1) / AUTO_GRID_STEP * AUTO_GRID_STEP);
+        config.width = config.height = side;
+    }
+    return config;
+}
+
+RunResult runArena(const Options& options, int snakes, int threads) {
+    RunResult result;
+    auto started = std::chrono::steady_clock::now();
+    ArenaConfig config = configFor(options, snakes);
+    Arena arena(config);
+    arena.reset(options.seed);
+    std::unique_ptr<WorkStealingPool> pool;
+    if (threads > 1) pool.reset(new WorkStealingPool(threads));
+    auto running = std::chrono::steady_clock::now();
+    result.setupMillis = std::chrono::duration<double, std::milli>(running - started).count();
+
+    long long aliveTotal = 0;
+    for (long long t = 0; t < options.ticks; t++) {
+        arena.step(pool.get());
+        aliveTotal += arena.getStats().alive;
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - running).count();
+    result.stats = arena.getStats();
+    result.averageAlive = static_cast<double>(aliveTotal) / options.ticks;
+    result.hash = arena.getStateHash();
+    result.width = config.width;
+    result.height = config.height;
+    for (const ArenaSnake& snake : arena.getSnakes()) {
+        if (snake.alive) result.topScores.push_back(snake.score);
+    }
+    std::sort(result.topScores.rbegin(), result.topScores.rend());
+    if (result.topScores.size() > 5) result.topScores.resize(5);
+    return result;
+}
+
+void printReport(const RunResult& run, int snakes, int threads) {
+    const ArenaStats& stats = run.stats;
+    std::printf("%d snakes on %dx%d, %llu ticks on %d thread(s) in %.2f s (setup %.1f ms)\n", snakes, run.width,
+                run.height, stats.ticks, threads, run.seconds, run.setupMillis);
+    std::printf("tick: %.1f us avg, %.1f us max, %.1f ns per moved cell\n", stats.averageTickMicros,
+                stats.maxTickMicros, stats.moves > 0 ? stats.averageTickMicros * stats.ticks * 1000.0 / stats.moves : 0.0);
+    std::printf("alive: %.1f avg, longest %d; %llu food eaten, %llu respawns, %llu cells freed\n", run.averageAlive,
+                stats.longest, stats.eaten, stats.respawns, stats.freedCells);
+    static const char* causeNames[ARENA_DEATH_COUNT] = { "boundary", "wall", "self", "body", "head-on" };
+    unsigned long long deaths = 0;
+    for (unsigned long long count : stats.deaths) deaths += count;
+    std::printf("deaths:");
+    for (int i = 0; i < ARENA_DEATH_COUNT; i++) {
+        std::printf("  %s %llu (%.1f%%)", causeNames[i], stats.deaths[i],
+                    deaths > 0 ? 100.0 * stats.deaths[i] / deaths : 0.0);
+    }
+    std::printf("\nleaders:");
+    for (int score : run.topScores) std::printf(" %d", score);
+    std::printf("\nstate hash %016llx\n", static_cast<unsigned long long>(run.hash));
+}
+
+bool parseStyle(const std::string& name, LevelStyle& style) {
+    for (int i = 0; i < LEVEL_STYLE_COUNT; i++) {
+        if (name == LevelGenerator::styleName(static_cast<LevelStyle>(i))) {
+            style = static_cast<LevelStyle>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--snakes" && hasValue) {
+            options.snakes = std::atoi(argv[++i]);
+        } else if (arg == "--grid" && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2) return false;
+        } else if (arg == "--ticks" && hasValue) {
+            options.ticks = std::atoll(argv[++i]);
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (arg == "--style" && hasValue) {
+            if (!parseStyle(argv[++i], options.style)) return false;
+        } else if (arg == "--food" && hasValue) {
+            options.foodPerSector = std::atoi(argv[++i]);
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--scaling") {
+            options.scaling = true;
+        } else {
+            return false;
+        }
+    }
+    bool gridOk = (options.width == 0 && options.height == 0) || (options.width >= 8 && options.height >= 8);
+    return options.snakes > 0 && options.ticks > 0 && options.foodPerSector >= 0 && gridOk;
+}
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cout << "Usage: snake_arena [--snakes N] [--grid WxH] [--ticks T] [--threads N]\n"
+                  << "                   [--style random|maze|rooms|symmetric] [--food N] [--seed S] [--scaling]"
+                  << std::endl;
+        return 1;
+    }
+    int threads = options.threads > 0 ? options.threads
+                                      : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    if (options.scaling) {
+        // Same density at every size, so flat ns per moved cell means the
+        // tick does not slow down as snakes are added
+        std::printf(" snakes      grid  tick us  ns/moved cell  alive\n");
+        std::vector<int> counts;
+        for (int snakes = 125; snakes < options.snakes; snakes *= 2) counts.push_back(snakes);
+        counts.push_back(options.snakes);
+        for (int snakes : counts) {
+            RunResult run = runArena(options, snakes, threads);
+            double perMove = run.stats.moves > 0 ? run.stats.averageTickMicros * run.stats.ticks * 1000.0 / run.stats.moves
+                                                 : 0.0;
+            std::printf("%7d  %4dx%-4d  %7.1f  %13.1f  %5.0f\n", snakes, run.width, run.height,
+                        run.stats.averageTickMicros, perMove, run.averageAlive);
+        }
+        return 0;
+    }
+
+    RunResult run = runArena(options, options.snakes, threads);
+    printReport(run, options.snakes, threads);
+
+    // Moves are chosen in parallel but applied in order, so one thread must
+    // reach the same state
+    if (threads > 1 && runArena(options, options.snakes, 1).hash != run.hash) {
+        std::cerr << "Results differ between thread counts" << std::endl;
+        return 1;
+    }
+    return 0;
+}
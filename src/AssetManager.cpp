@@ -0,0 +1,190 @@
+#include "AssetManager.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+namespace {
+bool fileExists(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return file.good();
+}
+
+std::string keyOf(const std::vector<std::string>& candidates) {
+    std::string key;
+    for (const auto& path : candidates) {
+        key += path;
+        key += '|';
+    }
+    return key;
+}
+}
+
+AssetManager::AssetManager() : stopping(false) {
+    worker = std::thread(&AssetManager::workerLoop, this);
+}
+
+AssetManager::~AssetManager() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        queue.clear();
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void AssetManager::request(Kind kind, const std::vector<std::string>& candidates,
+                           std::function<void(Asset&)> ready) {
+    std::string key = keyOf(candidates);
+    key += static_cast<char>('0' + kind);
+    auto found = assets.find(key);
+    if (found != assets.end()) {
+        Asset& asset = *found->second;
+        asset.callbacks.push_back(ready);
+        if (asset.delivered) {
+            // Already loaded: call back on the next poll()
+            asset.delivered = false;
+            undelivered.push_back(&asset);
+        }
+        return;
+    }
+
+    std::unique_ptr<Asset> created(new Asset());
+    Asset& asset = *created;
+    asset.kind = kind;
+    asset.candidates = candidates;
+    asset.callbacks.push_back(ready);
+    assets[key] = std::move(created);
+    undelivered.push_back(&asset);
+    stats.requested++;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(&asset);
+    }
+    wake.notify_one();
+}
+
+void AssetManager::requestTexture(const std::vector<std::string>& candidates, TextureReady ready) {
+    request(ASSET_TEXTURE, candidates, [ready](Asset& asset) { ready(asset.texture); });
+}
+
+void AssetManager::requestSound(const std::vector<std::string>& candidates, SoundReady ready) {
+    request(ASSET_SOUND, candidates, [ready](Asset& asset) { ready(asset.sound); });
+}
+
+void AssetManager::requestMusic(const std::vector<std::string>& candidates, MusicReady ready) {
+    request(ASSET_MUSIC, candidates, [ready](Asset& asset) { ready(*asset.music); });
+}
+
+void AssetManager::workerLoop() {
+    while (true) {
+        Asset* asset;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) return;
+            asset = queue.front();
+            queue.pop_front();
+        }
+        decode(*asset);
+    }
+}
+
+bool AssetManager::decodeFromPack(Asset& asset, const std::string& name) const {
+    size_t size = 0;
+    const uint8_t* data = pack.isOpen() ? pack.find(name, size) : nullptr;
+    if (!data) return false;
+    switch (asset.kind) {
+        case ASSET_TEXTURE:
+            return asset.image.loadFromMemory(data, size);
+        case ASSET_SOUND:
+            return asset.sound.loadFromMemory(data, size);
+        case ASSET_MUSIC:
+            // Streams from the mapping for as long as the pack stays open
+            asset.music.reset(new sf::Music());
+            return asset.music->openFromMemory(data, size);
+    }
+    return false;
+}
+
+bool AssetManager::decodeFromFile(Asset& asset, const std::string& path) const {
+    if (!fileExists(path)) return false;
+    switch (asset.kind) {
+        case ASSET_TEXTURE:
+            return asset.image.loadFromFile(path);
+        case ASSET_SOUND:
+            return asset.sound.loadFromFile(path);
+        case ASSET_MUSIC:
+            asset.music.reset(new sf::Music());
+            return asset.music->openFromFile(path);
+    }
+    return false;
+}
+
+void AssetManager::decode(Asset& asset) const {
+    auto start = std::chrono::steady_clock::now();
+    bool ok = false;
+    for (const auto& name : asset.candidates) {
+        if (decodeFromPack(asset, name)) {
+            asset.path = "pack:" + name;
+            ok = true;
+        } else if (decodeFromFile(asset, fallbackDirectory + name)) {
+            asset.path = fallbackDirectory + name;
+            ok = true;
+        }
+        if (ok) break;
+    }
+    asset.decodeMillis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    asset.status.store(ok ? ASSET_LOADED : ASSET_FAILED, std::memory_order_release);
+}
+
+void AssetManager::poll() {
+    // Callbacks may request more assets, which appends to undelivered
+    std::vector<Asset*> waiting;
+    waiting.swap(undelivered);
+    for (Asset* entry : waiting) {
+        Asset& asset = *entry;
+        int status = asset.status.load(std::memory_order_acquire);
+        if (status == ASSET_PENDING) {
+            undelivered.push_back(&asset);
+            continue;
+        }
+
+        if (!asset.counted) {
+            asset.counted = true;
+            if (status == ASSET_FAILED) {
+                std::cerr << "Failed to load " << asset.candidates.front() << std::endl;
+                stats.failed++;
+            } else {
+                stats.loaded++;
+            }
+            stats.decodeMillis += asset.decodeMillis;
+        }
+        if (status == ASSET_FAILED) {
+            // Nothing to hand out; requesters keep their fallbacks
+            asset.callbacks.clear();
+            asset.delivered = true;
+            continue;
+        }
+
+        if (asset.kind == ASSET_TEXTURE && asset.image.getSize().x > 0) {
+            if (!asset.texture.loadFromImage(asset.image)) {
+                std::cerr << "Failed to upload " << asset.path << std::endl;
+            }
+            asset.image = sf::Image();
+        }
+        for (auto& callback : asset.callbacks) {
+            callback(asset);
+        }
+        asset.callbacks.clear();
+        asset.delivered = true;
+    }
+}
+
+bool AssetManager::loadFont(sf::Font& font, const std::vector<std::string>& candidates) {
+    for (const auto& path : candidates) {
+        if (fileExists(path) && font.loadFromFile(path)) return true;
+    }
+    return false;
+}
@@ -0,0 +1,108 @@
+#ifndef ASSETMANAGER_H
+#define ASSETMANAGER_H
+
+#include <SFML/Audio.hpp>
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AssetPack.h"
+
+struct AssetLoadStats {
+    int requested = 0;          // Distinct assets (repeat requests are not counted)
+    int loaded = 0;
+    int failed = 0;
+    double decodeMillis = 0;    // Worker time spent reading and decoding
+};
+
+// Loads each texture, sound buffer and music stream once, keyed by its list
+// of candidate names (the first that loads wins). A name is looked up in the
+// asset pack first, and SFML decodes straight from the mapped bytes; names
+// missing from the pack (or with no pack open) are read from the fallback
+// directory instead. Files are read and decoded
+// on a background thread; poll(), called once per frame on the main thread,
+// uploads finished images to textures (OpenGL calls must stay on that thread)
+// and runs the ready callbacks there. A request for an asset that is already
+// loaded calls back on the next poll() without touching the disk again.
+//
+// Handles passed to the callbacks stay valid for the manager's lifetime, so
+// it should outlive every sf::Sound or sprite that refers to them.
+class AssetManager {
+public:
+    typedef std::function<void(const sf::Texture&)> TextureReady;
+    typedef std::function<void(const sf::SoundBuffer&)> SoundReady;
+    typedef std::function<void(sf::Music&)> MusicReady;
+
+private:
+    enum Kind { ASSET_TEXTURE, ASSET_SOUND, ASSET_MUSIC };
+    enum Status { ASSET_PENDING, ASSET_LOADED, ASSET_FAILED };
+
+    struct Asset {
+        Kind kind;
+        std::vector<std::string> candidates;
+        std::string path;               // Where it loaded from, for messages
+        std::atomic<int> status;        // Written by the worker, read by poll()
+        bool delivered = false;         // Every callback so far has run
+        bool counted = false;           // Included in stats
+        double decodeMillis = 0;
+        sf::Image image;                // Decoded on the worker, freed after upload
+        sf::Texture texture;
+        sf::SoundBuffer sound;
+        std::unique_ptr<sf::Music> music;
+        std::vector<std::function<void(Asset&)>> callbacks;
+
+        Asset() : status(ASSET_PENDING) {}
+    };
+
+    AssetPack pack;                     // Read-only once the worker has started work
+    std::string fallbackDirectory;
+    std::map<std::string, std::unique_ptr<Asset>> assets;
+    std::vector<Asset*> undelivered;    // Main-thread list of assets with work left for poll()
+    AssetLoadStats stats;
+
+    // Worker queue
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Asset*> queue;
+    bool stopping;
+    std::thread worker;
+
+    void request(Kind kind, const std::vector<std::string>& candidates, std::function<void(Asset&)> ready);
+    void workerLoop();
+    void decode(Asset& asset) const;
+    bool decodeFromPack(Asset& asset, const std::string& name) const;
+    bool decodeFromFile(Asset& asset, const std::string& path) const;
+
+public:
+    AssetManager();
+    ~AssetManager();
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+    // Call both before the first request
+    bool openPack(const std::string& path) { return pack.open(path); }
+    void setFallbackDirectory(const std::string& directory) { fallbackDirectory = directory; }
+
+    void requestTexture(const std::vector<std::string>& candidates, TextureReady ready);
+    void requestSound(const std::vector<std::string>& candidates, SoundReady ready);
+    void requestMusic(const std::vector<std::string>& candidates, MusicReady ready);
+    // Main thread, once per frame: finishes loaded assets and runs callbacks
+    void poll();
+    // True once every request so far has loaded (or failed) and called back
+    bool isIdle() const { return undelivered.empty(); }
+    const AssetLoadStats& getStats() const { return stats; }
+
+    // Fonts are needed by the very first frame, so they load synchronously.
+    // Candidates are checked for existence first, so missing ones cost no
+    // decoder setup or error output.
+    static bool loadFont(sf::Font& font, const std::vector<std::string>& candidates);
+};
+
+#endif
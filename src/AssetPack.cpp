@@ -0,0 +1,136 @@
+#include "AssetPack.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+const uint8_t MAGIC[4] = {'S', 'N', 'K', 'P'};
+const uint32_t FORMAT_VERSION = 1;
+const uint64_t DATA_ALIGNMENT = 64;
+const size_t HEADER_SIZE = 12;
+const size_t ENTRY_FIXED_SIZE = 18;     // offset, size, name length
+
+void putLittle(std::vector<uint8_t>& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+}
+
+uint64_t getLittle(const uint8_t* data, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= static_cast<uint64_t>(data[i]) << (i * 8);
+    }
+    return value;
+}
+}
+
+bool AssetPack::open(const std::string& path) {
+    entries.clear();
+    if (!file.open(path)) return false;
+
+    const uint8_t* data = file.getData();
+    size_t size = file.getSize();
+    bool valid = size >= HEADER_SIZE && std::memcmp(data, MAGIC, 4) == 0 &&
+                 getLittle(data + 4, 4) == FORMAT_VERSION;
+    uint64_t count = valid ? getLittle(data + 8, 4) : 0;
+    size_t cursor = HEADER_SIZE;
+    for (uint64_t i = 0; valid && i < count; i++) {
+        if (size - cursor < ENTRY_FIXED_SIZE) {
+            valid = false;
+            break;
+        }
+        AssetPackEntry entry;
+        entry.offset = getLittle(data + cursor, 8);
+        entry.size = getLittle(data + cursor + 8, 8);
+        size_t nameLength = static_cast<size_t>(getLittle(data + cursor + 16, 2));
+        cursor += ENTRY_FIXED_SIZE;
+        if (size - cursor < nameLength || entry.offset > size || entry.size > size - entry.offset) {
+            valid = false;
+            break;
+        }
+        entry.name.assign(reinterpret_cast<const char*>(data + cursor), nameLength);
+        cursor += nameLength;
+        entries.push_back(entry);
+    }
+    valid = valid && std::is_sorted(entries.begin(), entries.end(),
+                                    [](const AssetPackEntry& a, const AssetPackEntry& b) { return a.name < b.name; });
+    if (!valid) {
+        entries.clear();
+        file.close();
+    }
+    return valid;
+}
+
+const uint8_t* AssetPack::find(const std::string& name, size_t& size) const {
+    auto found = std::lower_bound(entries.begin(), entries.end(), name,
+                                  [](const AssetPackEntry& entry, const std::string& key) { return entry.name < key; });
+    if (found == entries.end() || found->name != name) return nullptr;
+    size = static_cast<size_t>(found->size);
+    return file.getData() + found->offset;
+}
+
+bool AssetPack::build(const std::string& directory, const std::string& outputPath) {
+    namespace fs = std::filesystem;
+    std::error_code error;
+    std::vector<AssetPackEntry> packed;
+    for (fs::recursive_directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        if (!it->is_regular_file()) continue;
+        AssetPackEntry entry;
+        entry.name = it->path().lexically_relative(directory).generic_string();
+        entry.size = it->file_size();
+        if (entry.name.size() > 0xFFFF) {
+            std::cerr << "Asset name too long: " << entry.name << std::endl;
+            return false;
+        }
+        packed.push_back(entry);
+    }
+    if (error) {
+        std::cerr << "Cannot read " << directory << ": " << error.message() << std::endl;
+        return false;
+    }
+    std::sort(packed.begin(), packed.end(),
+              [](const AssetPackEntry& a, const AssetPackEntry& b) { return a.name < b.name; });
+
+    // Lay the files out after the index, in index order
+    uint64_t offset = HEADER_SIZE;
+    for (const auto& entry : packed) offset += ENTRY_FIXED_SIZE + entry.name.size();
+    for (auto& entry : packed) {
+        offset = (offset + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+        entry.offset = offset;
+        offset += entry.size;
+    }
+
+    std::vector<uint8_t> header(MAGIC, MAGIC + 4);
+    putLittle(header, FORMAT_VERSION, 4);
+    putLittle(header, packed.size(), 4);
+    for (const auto& entry : packed) {
+        putLittle(header, entry.offset, 8);
+        putLittle(header, entry.size, 8);
+        putLittle(header, entry.name.size(), 2);
+        header.insert(header.end(), entry.name.begin(), entry.name.end());
+    }
+
+    std::ofstream out(outputPath, std::ios::binary);
+    if (!out) {
+        std::cerr << "Cannot write " << outputPath << std::endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(header.data()), header.size());
+    uint64_t written = header.size();
+    std::vector<char> buffer;
+    for (const auto& entry : packed) {
+        buffer.assign(static_cast<size_t>(entry.offset - written), 0);
+        std::ifstream in(fs::path(directory) / entry.name, std::ios::binary);
+        buffer.resize(buffer.size() + static_cast<size_t>(entry.size));
+        if (!in.read(buffer.data() + (entry.offset - written), static_cast<std::streamsize>(entry.size))) {
+            std::cerr << "Cannot read " << entry.name << std::endl;
+            return false;
+        }
+        out.write(buffer.data(), buffer.size());
+        written = entry.offset + entry.size;
+    }
+    return static_cast<bool>(out);
+}
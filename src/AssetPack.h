@@ -0,0 +1,43 @@
+#ifndef ASSETPACK_H
+#define ASSETPACK_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+struct AssetPackEntry {
+    std::string name;           // Path relative to the packed directory, '/' separated
+    uint64_t offset = 0;        // From the start of the archive
+    uint64_t size = 0;
+};
+
+// All game assets in one archive: a small index followed by the files back
+// to back (64-byte aligned, in index order), so loading them is one open,
+// one mmap and a sequential read through the page cache.
+//
+//   "SNKP" | u32 version | u32 count | count x (u64 offset, u64 size,
+//   u16 name length, name) | data
+//
+// Integers are little-endian and the index is sorted by name. The archive
+// is mapped, not read: find() returns pointers into the mapping, which
+// decoders such as SFML's loadFromMemory can read directly.
+class AssetPack {
+private:
+    MappedFile file;
+    std::vector<AssetPackEntry> entries;
+
+public:
+    bool open(const std::string& path);
+    bool isOpen() const { return file.isOpen(); }
+    // Bytes of the named asset, or nullptr if the archive has no such entry
+    const uint8_t* find(const std::string& name, size_t& size) const;
+    const std::vector<AssetPackEntry>& getEntries() const { return entries; }
+
+    // Packs every regular file under `directory`; false (with a message on
+    // stderr) on any I/O error
+    static bool build(const std::string& directory, const std::string& outputPath);
+};
+
+#endif
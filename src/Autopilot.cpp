@@ -0,0 +1,158 @@
+#include "Autopilot.h"
+#include <chrono>
+#include <algorithm>
+
+namespace {
+const int DX[4] = { 0, 0, -1, 1 };  // Indexed by Direction
+const int DY[4] = { -1, 1, 0, 0 };
+}
+
+Autopilot::Autopilot(int width, int height) :
+    width(width), height(height), generation(0), totalMicros(0) {}
+
+void Autopilot::allocateBuffers() {
+    // Deferred to the first plan: on large boards an unused autopilot (e.g.
+    // the Hamiltonian solver's fallback) should not cost memory
+    size_t cells = static_cast<size_t>(width) * height;
+    visited.assign(cells, 0);
+    parent.assign(cells, -1);
+    openList.assign(cells, 0);
+}
+
+void Autopilot::nextGeneration() {
+    if (++generation == 0) {
+        // Stamp wrapped around: old marks would look current again
+        std::fill(visited.begin(), visited.end(), 0);
+        generation = 1;
+    }
+}
+
+bool Autopilot::isFree(const Simulation& sim, int x, int y) const {
+    if (sim.getGraph().isWall(x, y)) return false;
+
+    // The tail cell is vacated on the next move, unless the snake is growing
+    const Snake& snake = sim.getSnake();
+    if (!snake.checkCollision(x, y)) return true;
+    SnakeSegment tail = snake.getTail();
+    return !snake.isGrowing() && tail.x == x && tail.y == y;
+}
+
+int Autopilot::searchFood(const Simulation& sim, int startIndex) {
+    const Food& food = sim.getFood();
+    int head = 0, tail = 0;
+    openList[tail++] = startIndex;
+    visited[startIndex] = generation;
+    parent[startIndex] = -1;
+
+    while (head < tail) {
+        int current = openList[head++];
+        int cx = current % width;
+        int cy = current / width;
+        if (current != startIndex && food.contains(cx, cy)) {
+            stats.lastExpanded = head;
+            return current;
+        }
+
+        for (int d = 0; d < 4; d++) {
+            int nx = cx + DX[d];
+            int ny = cy + DY[d];
+            if (!isFree(sim, nx, ny)) continue;
+
+            int next = ny * width + nx;
+            if (visited[next] == generation) continue;
+            visited[next] = generation;
+            parent[next] = current;
+            openList[tail++] = next;
+        }
+    }
+
+    stats.lastExpanded = head;
+    return -1;
+}
+
+int Autopilot::floodCount(const Simulation& sim, int startIndex) {
+    nextGeneration();
+    int head = 0, tail = 0;
+    openList[tail++] = startIndex;
+    visited[startIndex] = generation;
+
+    while (head < tail) {
+        int current = openList[head++];
+        int cx = current % width;
+        int cy = current / width;
+        for (int d = 0; d < 4; d++) {
+            int nx = cx + DX[d];
+            int ny = cy + DY[d];
+            if (!isFree(sim, nx, ny)) continue;
+
+            int next = ny * width + nx;
+            if (visited[next] == generation) continue;
+            visited[next] = generation;
+            openList[tail++] = next;
+        }
+    }
+    return tail;
+}
+
+Direction Autopilot::decide(const Simulation& sim) {
+    auto start = std::chrono::steady_clock::now();
+
+    const Snake& snake = sim.getSnake();
+    SnakeSegment head = snake.getHead();
+    Direction choice = snake.getDirection();
+    stats.lastPathLength = 0;
+
+    if (head.x >= 0 && head.x < width && head.y >= 0 && head.y < height) {
+        if (visited.empty()) allocateBuffers();
+        nextGeneration();
+
+        int startIndex = head.y * width + head.x;
+        int target = searchFood(sim, startIndex);
+
+        if (target >= 0) {
+            // Walk back to the cell right after the head
+            int step = target;
+            stats.lastPathLength = 1;
+            while (parent[step] != startIndex) {
+                step = parent[step];
+                stats.lastPathLength++;
+            }
+            int sx = step % width;
+            int sy = step / width;
+            for (int d = 0; d < 4; d++) {
+                if (head.x + DX[d] == sx && head.y + DY[d] == sy) {
+                    choice = static_cast<Direction>(d);
+                    break;
+                }
+            }
+        } else {
+            // No food reachable: head for the largest open region
+            int bestArea = -1;
+            for (int d = 0; d < 4; d++) {
+                int nx = head.x + DX[d];
+                int ny = head.y + DY[d];
+                if (!isFree(sim, nx, ny)) continue;
+
+                int area = floodCount(sim, ny * width + nx);
+                if (area > bestArea) {
+                    bestArea = area;
+                    choice = static_cast<Direction>(d);
+                }
+            }
+        }
+    }
+
+    double micros = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+    stats.plans++;
+    stats.lastMicros = micros;
+    stats.maxMicros = std::max(stats.maxMicros, micros);
+    totalMicros += micros;
+    stats.averageMicros = totalMicros / stats.plans;
+    return choice;
+}
+
+void Autopilot::resetStats() {
+    stats = AutopilotStats();
+    totalMicros = 0;
+}
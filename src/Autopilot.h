@@ -0,0 +1,47 @@
+#ifndef AUTOPILOT_H
+#define AUTOPILOT_H
+
+#include <vector>
+#include <cstdint>
+#include "Simulation.h"
+
+struct AutopilotStats {
+    double lastMicros = 0;
+    double averageMicros = 0;
+    double maxMicros = 0;
+    int lastExpanded = 0;       // Cells dequeued by the last search
+    int lastPathLength = 0;     // 0 when no food was reachable
+    unsigned long long plans = 0;
+};
+
+// Greedy autopilot: breadth-first search from the head to the nearest food
+// through cells not blocked by walls or the body. All search buffers are
+// sized to the grid on the first plan, and cells are marked with a
+// generation stamp instead of being cleared, so a plan never allocates.
+// Food cells are read from Food's occupancy bitset, so a plan costs nothing
+// per food item on the board.
+class Autopilot {
+private:
+    int width, height;
+    std::vector<uint32_t> visited;      // Closed set: cell stamped with the current generation
+    std::vector<int> parent;            // Predecessor of each visited cell
+    std::vector<int> openList;          // BFS queue, at most one entry per cell
+    uint32_t generation;
+    AutopilotStats stats;
+    double totalMicros;
+
+    void nextGeneration();
+    void allocateBuffers();
+    bool isFree(const Simulation& sim, int x, int y) const;
+    int searchFood(const Simulation& sim, int startIndex);
+    int floodCount(const Simulation& sim, int startIndex);
+
+public:
+    Autopilot(int width, int height);
+    // Direction the snake should take on the next tick
+    Direction decide(const Simulation& sim);
+    const AutopilotStats& getStats() const { return stats; }
+    void resetStats();
+};
+
+#endif
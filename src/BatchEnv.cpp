@@ -0,0 +1,306 @@
+#include "BatchEnv.h"
+#include <algorithm>
+
+namespace {
+int bitCount(uint64_t bits) {
+    bits = bits - ((bits >> 1) & 0x5555555555555555ULL);
+    bits = (bits & 0x3333333333333333ULL) + ((bits >> 2) & 0x3333333333333333ULL);
+    bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((bits * 0x0101010101010101ULL) >> 56);
+}
+}
+
+BatchEnv::BatchEnv(int count, int width, int height, int maxFood) :
+    count(count),
+    width(width),
+    height(height),
+    cells(width * height),
+    words((width * height + 63) / 64),
+    maxFood(maxFood),
+    ringMask(0),
+    ringStride(0),
+    levelStyle(LEVEL_RANDOM),
+    maxEpisodeTicks(0),
+    stepCount(0),
+    episodeCount(0) {
+    // The snake can never be longer than the board
+    int capacity = 4;
+    while (capacity < cells) capacity <<= 1;
+    ringMask = capacity - 1;
+    ringStride = capacity + 16;
+
+    size_t boards = static_cast<size_t>(count);
+    headX.resize(boards);
+    headY.resize(boards);
+    direction.resize(boards);
+    length.resize(boards);
+    headIndex.resize(boards);
+    tailCell.resize(boards);
+    growing.resize(boards);
+    score.resize(boards);
+    level.resize(boards);
+    ticks.resize(boards);
+    layout.assign(boards, 0);
+    food.assign(boards * maxFood, -1);
+    ring.resize(boards * ringStride);
+    bodyBits.assign(boards * words, 0);
+    wallBank.assign(static_cast<size_t>(words), 0);
+    rngs.resize(boards);
+
+    rewards.resize(boards);
+    dones.resize(boards);
+    finalScores.resize(boards);
+    finalLengths.resize(boards);
+    finalCauses.resize(boards);
+
+    nextX.resize(boards);
+    nextY.resize(boards);
+    nextCell.resize(boards);
+    causes.resize(boards);
+    ate.resize(boards);
+}
+
+void BatchEnv::reset(uint64_t seed) {
+    // Wall bank: layouts LevelGenerator would give a new game, generated once
+    // here so resetting a board costs a few stores
+    LevelGenerator generator(width, height);
+    Graph graph(width, height);
+    Snake start(START_X, START_Y, width, height);
+    generator.seed(seed);
+    wallBank.assign(static_cast<size_t>(LAYOUT_BANK) * words, 0);
+    for (int i = 0; i < LAYOUT_BANK; i++) {
+        generator.generate(graph, 1, levelStyle, &start);
+        uint64_t* bits = &wallBank[static_cast<size_t>(i) * words];
+        graph.forEachWall([&](int x, int y) {
+            int cell = y * width + x;
+            bits[cell >> 6] |= uint64_t(1) << (cell & 63);
+        });
+    }
+
+    Random seeder(seed ^ 0xBA7C4E4BBA7C4E4BULL);
+    for (int env = 0; env < count; env++) {
+        rngs[env].seed(seeder.next());
+        resetBoard(env);
+        rewards[env] = 0;
+        dones[env] = 0;
+        finalScores[env] = 0;
+        finalLengths[env] = 0;
+        finalCauses[env] = DEATH_NONE;
+    }
+    stepCount = 0;
+    episodeCount = 0;
+}
+
+bool BatchEnv::isFree(int env, int cell) const {
+    if (testBit(walls(env), cell) || testBit(&bodyBits[static_cast<size_t>(env) * words], cell)) return false;
+    for (int slot = 0; slot < maxFood; slot++) {
+        if (food[static_cast<size_t>(slot) * count + env] == cell) return false;
+    }
+    return true;
+}
+
+bool BatchEnv::spawnFood(int env, int slot) {
+    // Random probes find a free cell at once on all but nearly full boards;
+    // after that, pick uniformly by counting the free cells
+    Random& rng = rngs[env];
+    int32_t& target = food[static_cast<size_t>(slot) * count + env];
+    for (int attempt = 0; attempt < SPAWN_TRIES; attempt++) {
+        int cell = rng.nextBelow(cells);
+        if (isFree(env, cell)) {
+            target = cell;
+            return true;
+        }
+    }
+
+    const uint64_t* wallBits = walls(env);
+    const uint64_t* body = &bodyBits[static_cast<size_t>(env) * words];
+    int open = 0;
+    for (int w = 0; w < words; w++) {
+        uint64_t valid = (w == words - 1 && cells % 64 != 0) ? (uint64_t(1) << (cells % 64)) - 1 : ~uint64_t(0);
+        open += bitCount(~(wallBits[w] | body[w]) & valid);
+    }
+    for (int other = 0; other < maxFood; other++) {
+        if (food[static_cast<size_t>(other) * count + env] >= 0) open--;
+    }
+    if (open <= 0) return false;
+
+    int pick = rng.nextBelow(open);
+    for (int cell = 0; cell < cells; cell++) {
+        if (isFree(env, cell) && pick-- == 0) {
+            target = cell;
+            return true;
+        }
+    }
+    return false;
+}
+
+void BatchEnv::resetBoard(int env) {
+    std::fill_n(bodyBits.begin() + static_cast<size_t>(env) * words, words, 0);
+    for (int slot = 0; slot < maxFood; slot++) {
+        food[static_cast<size_t>(slot) * count + env] = -1;
+    }
+    layout[env] = rngs[env].nextBelow(LAYOUT_BANK);
+
+    // Same snake as Snake::reset(START_X, START_Y): three cells heading right
+    int32_t* body = &ring[static_cast<size_t>(env) * ringStride];
+    uint64_t* bits = &bodyBits[static_cast<size_t>(env) * words];
+    for (int i = 0; i < 3; i++) {
+        int cell = START_Y * width + START_X - 2 + i;
+        body[i] = cell;
+        bits[cell >> 6] |= uint64_t(1) << (cell & 63);
+    }
+    headIndex[env] = 2;
+    tailCell[env] = body[0];
+    length[env] = 3;
+    headX[env] = START_X;
+    headY[env] = START_Y;
+    direction[env] = RIGHT;
+    growing[env] = 0;
+    score[env] = 0;
+    level[env] = 1;
+    ticks[env] = 0;
+
+    for (int slot = 0; slot < maxFood; slot++) {
+        spawnFood(env, slot);
+    }
+}
+
+void BatchEnv::finish(int env, DeathCause cause) {
+    dones[env] = 1;
+    finalScores[env] = score[env];
+    finalLengths[env] = length[env];
+    finalCauses[env] = cause;
+    resetBoard(env);
+}
+
+void BatchEnv::stepRange(const int32_t* actions, int begin, int end) {
+    int32_t* dir = direction.data();
+    int32_t* outX = nextX.data();
+    int32_t* outY = nextY.data();
+    int32_t* target = nextCell.data();
+    int32_t* cause = causes.data();
+    int32_t* eaten = ate.data();
+
+    // Turns: Direction values pair up as UP/DOWN and LEFT/RIGHT, so the
+    // reverse of d is d ^ 1
+    if (actions) {
+        for (int e = begin; e < end; e++) {
+            int32_t wanted = actions[e] & 3;
+            dir[e] = (wanted ^ 1) == dir[e] ? dir[e] : wanted;
+        }
+    }
+
+    // Movement and boundary check. Off-board heads look up cell 0 below so
+    // every load stays in range; their cause is already set.
+    const int32_t* x = headX.data();
+    const int32_t* y = headY.data();
+    for (int e = begin; e < end; e++) {
+        int32_t d = dir[e];
+        int32_t nx = x[e] + (d == RIGHT) - (d == LEFT);
+        int32_t ny = y[e] + (d == DOWN) - (d == UP);
+        int32_t outside = (static_cast<uint32_t>(nx) >= static_cast<uint32_t>(width)) |
+                          (static_cast<uint32_t>(ny) >= static_cast<uint32_t>(height));
+        outX[e] = nx;
+        outY[e] = ny;
+        target[e] = outside ? 0 : ny * width + nx;
+        cause[e] = outside ? DEATH_BOUNDARY : DEATH_NONE;
+    }
+
+    // Wall and self checks: one bit each from the board's bitsets. The tail
+    // moves out first unless the snake is growing, so the head may follow it.
+    const uint64_t* bank = wallBank.data();
+    const uint64_t* body = bodyBits.data();
+    const int32_t* layouts = layout.data();
+    const int32_t* tails = tailCell.data();
+    const int32_t* grows = growing.data();
+    for (int e = begin; e < end; e++) {
+        int32_t cell = target[e];
+        size_t word = static_cast<size_t>(cell >> 6);
+        int32_t wall = static_cast<int32_t>((bank[static_cast<size_t>(layouts[e]) * words + word] >> (cell & 63)) & 1);
+        int32_t occupied = static_cast<int32_t>((body[static_cast<size_t>(e) * words + word] >> (cell & 63)) & 1);
+        int32_t self = occupied & !(cell == tails[e] && !grows[e]);
+        int32_t none = cause[e] == DEATH_NONE;
+        cause[e] = none & wall ? DEATH_WALL : (none & self ? DEATH_SELF : cause[e]);
+    }
+
+    // Food hits, one pass per food slot
+    for (int e = begin; e < end; e++) {
+        eaten[e] = 0;
+    }
+    for (int slot = 0; slot < maxFood; slot++) {
+        const int32_t* cellsOfSlot = &food[static_cast<size_t>(slot) * count];
+        for (int e = begin; e < end; e++) {
+            eaten[e] |= (cellsOfSlot[e] == target[e]) & (cause[e] == DEATH_NONE);
+        }
+    }
+
+    // Apply the outcomes board by board
+    for (int e = begin; e < end; e++) {
+        ticks[e]++;
+        dones[e] = 0;
+        if (cause[e] != DEATH_NONE) {
+            rewards[e] = -1.0f;
+            finish(e, static_cast<DeathCause>(cause[e]));
+            continue;
+        }
+
+        int32_t* boardRing = &ring[static_cast<size_t>(e) * ringStride];
+        uint64_t* bits = &bodyBits[static_cast<size_t>(e) * words];
+        if (!growing[e]) {
+            int32_t tail = tailCell[e];
+            bits[tail >> 6] &= ~(uint64_t(1) << (tail & 63));
+            length[e]--;
+            tailCell[e] = boardRing[(headIndex[e] - length[e] + 1) & ringMask];
+        }
+        growing[e] = 0;
+        int32_t cell = target[e];
+        headIndex[e] = (headIndex[e] + 1) & ringMask;
+        boardRing[headIndex[e]] = cell;
+        bits[cell >> 6] |= uint64_t(1) << (cell & 63);
+        length[e]++;
+        headX[e] = nextX[e];
+        headY[e] = nextY[e];
+
+        rewards[e] = 0;
+        if (eaten[e]) {
+            rewards[e] = 1.0f;
+            growing[e] = 1;
+            score[e] += POINTS_PER_FOOD;
+            level[e] = 1 + score[e] / POINTS_PER_LEVEL;
+            bool stocked = false;
+            for (int slot = 0; slot < maxFood; slot++) {
+                int32_t& item = food[static_cast<size_t>(slot) * count + e];
+                if (item == cell) item = -1;
+                if (item < 0) spawnFood(e, slot);
+                stocked |= item >= 0;
+            }
+            if (!stocked) {
+                // Nothing left to eat: the board is full
+                finish(e, DEATH_NONE);
+                continue;
+            }
+        }
+        if (maxEpisodeTicks > 0 && ticks[e] >= maxEpisodeTicks) {
+            finish(e, DEATH_NONE);
+        }
+    }
+}
+
+void BatchEnv::step(const int32_t* actions, WorkStealingPool* pool) {
+    if (pool && count > STEP_BLOCK) {
+        long long blocks = (count + STEP_BLOCK - 1) / STEP_BLOCK;
+        pool->parallelFor(blocks, 1, [&](long long block, int) {
+            int begin = static_cast<int>(block) * STEP_BLOCK;
+            stepRange(actions, begin, std::min(count, begin + STEP_BLOCK));
+        });
+    } else {
+        stepRange(actions, 0, count);
+    }
+
+    unsigned long long finished = 0;
+    for (int e = 0; e < count; e++) {
+        finished += dones[e];
+    }
+    episodeCount += finished;
+    stepCount += static_cast<unsigned long long>(count);
+}
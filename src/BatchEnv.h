@@ -0,0 +1,129 @@
+#ifndef BATCHENV_H
+#define BATCHENV_H
+
+#include <vector>
+#include <cstdint>
+#include "Simulation.h"
+#include "Random.h"
+#include "WorkStealingPool.h"
+
+// Many independent single-snake boards of one size, stepped in lockstep for
+// training and evaluating AI policies. Follows the Simulation rules
+// (movement, boundary, wall, self and food checks, 10 points per food, a new
+// level every 100 points) with two simplifications that keep a step a few
+// nanoseconds: each episode plays on one wall layout drawn from a bank built
+// by LevelGenerator at reset(seed), so levels count up without new walls,
+// and every board starts from the same snake as Simulation::reset().
+//
+// State is stored as structure-of-arrays (one array per field, indexed by
+// board) so step() runs each rule as a branch-free loop over the whole batch
+// that the compiler vectorizes; only the moves themselves (ring buffer and
+// bitset updates, food respawns) are done board by board.
+//
+// A finished board (death, no room left for food, or the tick limit) is
+// reset within the same step: its done flag is set, getFinal*() describe the
+// episode that ended and the other arrays already show the new one.
+class BatchEnv {
+private:
+    int count;
+    int width, height;
+    int cells;
+    int words;                      // Bitset words per board
+    int maxFood;
+    int ringMask;                   // Body ring capacity - 1 (a power of two)
+    int ringStride;                 // Capacity plus a cache line, so boards' rings do not share cache sets
+    LevelStyle levelStyle;
+    int maxEpisodeTicks;
+    unsigned long long stepCount;
+    unsigned long long episodeCount;
+
+    // Per-board state
+    std::vector<int32_t> headX, headY;
+    std::vector<int32_t> direction;
+    std::vector<int32_t> length;
+    std::vector<int32_t> headIndex;         // Slot of the head in the board's ring
+    std::vector<int32_t> tailCell;
+    std::vector<int32_t> growing;
+    std::vector<int32_t> score, level, ticks;
+    std::vector<int32_t> layout;            // Index into the wall bank
+    std::vector<int32_t> food;              // maxFood slots of count boards, slot-major; -1 is empty
+    std::vector<int32_t> ring;              // Body cells, ringStride per board
+    std::vector<uint64_t> bodyBits;         // words per board
+    std::vector<uint64_t> wallBank;         // words per layout
+    std::vector<Random> rngs;
+
+    // Step outputs
+    std::vector<float> rewards;
+    std::vector<uint8_t> dones;
+    std::vector<int32_t> finalScores, finalLengths, finalCauses;
+
+    // Step scratch
+    std::vector<int32_t> nextX, nextY, nextCell, causes, ate;
+
+    static const int START_X = 5;
+    static const int START_Y = 5;
+    static const int POINTS_PER_FOOD = 10;
+    static const int POINTS_PER_LEVEL = 100;
+    static const int LAYOUT_BANK = 64;
+    static const int SPAWN_TRIES = 32;
+    static const int STEP_BLOCK = 1024;     // Boards per parallel task
+
+    const uint64_t* walls(int env) const { return &wallBank[static_cast<size_t>(layout[env]) * words]; }
+    bool testBit(const uint64_t* bits, int cell) const { return (bits[cell >> 6] >> (cell & 63)) & 1; }
+    bool isFree(int env, int cell) const;
+    bool spawnFood(int env, int slot);
+    void resetBoard(int env);
+    void finish(int env, DeathCause cause);
+    void stepRange(const int32_t* actions, int begin, int end);
+
+public:
+    // Boards must be at least 10x8 so the starting snake and the cells
+    // kept open ahead of it fit
+    BatchEnv(int count, int width, int height, int maxFood = 3);
+    // Wall layout style used from the next reset(seed) on
+    void setLevelStyle(LevelStyle style) { levelStyle = style; }
+    // Ends episodes after this many ticks (0 = no limit)
+    void setMaxEpisodeTicks(int ticks) { maxEpisodeTicks = ticks; }
+    // Rebuilds the wall bank and restarts every board; results are a pure
+    // function of seed and actions
+    void reset(uint64_t seed);
+    // One tick on every board. actions[i] is the Direction for board i (a
+    // reversal is ignored, as in Snake::setDirection); nullptr keeps headings.
+    // With a pool, blocks of boards step on all its threads; results are the
+    // same either way.
+    void step(const int32_t* actions, WorkStealingPool* pool = nullptr);
+
+    int getCount() const { return count; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getMaxFood() const { return maxFood; }
+    int getWordsPerBoard() const { return words; }
+    unsigned long long getStepCount() const { return stepCount; }         // Board ticks
+    unsigned long long getEpisodeCount() const { return episodeCount; }   // Finished episodes
+
+    const int32_t* getHeadX() const { return headX.data(); }
+    const int32_t* getHeadY() const { return headY.data(); }
+    const int32_t* getDirections() const { return direction.data(); }
+    const int32_t* getLengths() const { return length.data(); }
+    const int32_t* getScores() const { return score.data(); }
+    const int32_t* getLevels() const { return level.data(); }
+    const int32_t* getTicks() const { return ticks.data(); }
+    // Food cell (y * width + x) in `slot` of every board, -1 when empty
+    const int32_t* getFood(int slot) const { return &food[static_cast<size_t>(slot) * count]; }
+    const uint64_t* getWallBits(int env) const { return walls(env); }
+    const uint64_t* getBodyBits(int env) const { return &bodyBits[static_cast<size_t>(env) * words]; }
+    // Cell of body segment i of a board; 0 is the head
+    int getBodyCell(int env, int i) const {
+        return ring[static_cast<size_t>(env) * ringStride + ((headIndex[env] - i) & ringMask)];
+    }
+
+    // Results of the last step: +1 for food, -1 for a death, else 0
+    const float* getRewards() const { return rewards.data(); }
+    const uint8_t* getDones() const { return dones.data(); }
+    // Episode that ended on boards whose done flag is set
+    const int32_t* getFinalScores() const { return finalScores.data(); }
+    const int32_t* getFinalLengths() const { return finalLengths.data(); }
+    const int32_t* getFinalCauses() const { return finalCauses.data(); }   // DeathCause; DEATH_NONE if not a death
+};
+
+#endif
@@ -0,0 +1,527 @@
+#include "Snake.h"
+#include "Food.h"
+#include "FreeCellSet.h"
+#include "Graph.h"
+#include "LevelGenerator.h"
+#include "ScoreManager.h"
+#include "ScoreStore.h"
+#include "Random.h"
+#include "BatchEnv.h"
+#include "Arena.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Microbenchmarks for the SnakeCore hot paths at several grid sizes.
+//   snake_bench [--sizes 30x20,256x256] [--min-time seconds] [--out file.json]
+// Prints one JSON document (to stdout unless --out is given); progress goes
+// to stderr. Build with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+
+namespace {
+volatile uint64_t sink;             // Keeps measured results observable
+double minSeconds = 0.2;            // Timed work per case
+
+struct GridSize {
+    int width, height;
+};
+
+struct BenchResult {
+    std::string name;
+    GridSize grid;
+    std::string param;
+    unsigned long long ops;
+    double seconds;
+};
+
+std::vector<BenchResult> results;
+
+// Accumulates time only between begin() and end(), so per-batch setup and
+// cleanup stay out of the measurement
+class Stopwatch {
+private:
+    std::chrono::steady_clock::time_point started;
+    double total = 0;
+
+public:
+    void begin() { started = std::chrono::steady_clock::now(); }
+    void end() { total += std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count(); }
+    double seconds() const { return total; }
+};
+
+void report(const char* name, GridSize grid, const std::string& param, unsigned long long ops, double seconds) {
+    results.push_back(BenchResult{name, grid, param, ops, seconds});
+    std::fprintf(stderr, "  %-30s %-14s %10.2f ns/op\n", name, param.c_str(), seconds * 1e9 / ops);
+}
+
+std::string param(const char* key, long long value) {
+    return std::string(key) + "=" + std::to_string(value);
+}
+
+long long cellCount(GridSize grid) {
+    return static_cast<long long>(grid.width) * grid.height;
+}
+
+// Direction that keeps a snake on a Hamiltonian cycle of a grid with even
+// height: right along row 0, serpentine through columns 1.., back up column 0
+Direction cycleDirection(int x, int y, GridSize grid) {
+    if (x == 0) return y == 0 ? RIGHT : UP;
+    if (y == 0) return x == grid.width - 1 ? DOWN : RIGHT;
+    if (y % 2 == 1) {
+        if (x > 1) return LEFT;
+        return y == grid.height - 1 ? LEFT : DOWN;
+    }
+    return x < grid.width - 1 ? RIGHT : DOWN;
+}
+
+void cycleStep(Snake& snake, GridSize grid) {
+    SnakeSegment head = snake.getHead();
+    snake.setDirection(cycleDirection(head.x, head.y, grid));
+    snake.move();
+}
+
+std::vector<Position> randomCells(GridSize grid, int count, Random& rng) {
+    std::vector<Position> cells(count);
+    for (auto& cell : cells) {
+        cell = Position(rng.nextBelow(grid.width), rng.nextBelow(grid.height));
+    }
+    return cells;
+}
+
+void benchSnake(GridSize grid) {
+    Random rng(1);
+    Snake snake(2, 0, grid.width, grid.height);
+
+    // Half the board, laid along the cycle so it never collides
+    long long length = std::min<long long>(cellCount(grid) / 2, 1 << 22);
+    while (snake.getLength() < length) {
+        snake.grow();
+        cycleStep(snake, grid);
+    }
+
+    const int BATCH = 4096;
+    Stopwatch watch;
+    unsigned long long ops = 0;
+    while (watch.seconds() < minSeconds) {
+        watch.begin();
+        for (int i = 0; i < BATCH; i++) {
+            cycleStep(snake, grid);
+        }
+        watch.end();
+        ops += BATCH;
+    }
+    sink = snake.getHead().x;
+    report("snake_move", grid, param("length", snake.getLength()), ops, watch.seconds());
+
+    Stopwatch selfWatch;
+    ops = 0;
+    uint64_t hits = 0;
+    while (selfWatch.seconds() < minSeconds) {
+        selfWatch.begin();
+        for (int i = 0; i < BATCH; i++) {
+            hits += snake.checkSelfCollision();
+        }
+        selfWatch.end();
+        ops += BATCH;
+    }
+    sink = hits;
+    report("snake_check_self_collision", grid, param("length", snake.getLength()), ops, selfWatch.seconds());
+
+    std::vector<Position> queries = randomCells(grid, BATCH, rng);
+    Stopwatch queryWatch;
+    ops = 0;
+    while (queryWatch.seconds() < minSeconds) {
+        queryWatch.begin();
+        for (const auto& cell : queries) {
+            hits += snake.checkCollision(cell.x, cell.y);
+        }
+        queryWatch.end();
+        ops += queries.size();
+    }
+    sink = hits;
+    report("snake_check_collision", grid, param("length", snake.getLength()), ops, queryWatch.seconds());
+}
+
+void benchFoodSpawn(GridSize grid, int fillPercent) {
+    Random rng(2);
+    FreeCellSet freeCells(grid.width, grid.height);
+    freeCells.fill();
+    for (int y = 0; y < grid.height; y++) {
+        for (int x = 0; x < grid.width; x++) {
+            if (rng.nextBelow(100) < fillPercent) freeCells.erase(x, y);
+        }
+    }
+    if (freeCells.empty()) return;
+
+    // Each batch takes `batch` cells out of the set and the cleanup returns them
+    int batch = std::min(256, freeCells.size());
+    Food food(batch);
+    Stopwatch watch;
+    unsigned long long ops = 0;
+    while (watch.seconds() < minSeconds) {
+        watch.begin();
+        food.spawnRandom(freeCells);
+        watch.end();
+        ops += batch;
+
+        for (const auto& position : food.getPositions()) {
+            freeCells.insert(position.x, position.y);
+        }
+        food.clear();
+    }
+    report("food_spawn_random", grid, param("fill_pct", fillPercent), ops, watch.seconds());
+}
+
+void benchFoodCollision(GridSize grid) {
+    Random rng(3);
+    int items = static_cast<int>(std::min<long long>(4096, cellCount(grid) / 2));
+    FreeCellSet freeCells(grid.width, grid.height);
+    freeCells.fill();
+    // Sized to the grid as in Simulation, so misses are answered by the bitset
+    Food food(items, grid.width, grid.height);
+    food.spawnRandom(freeCells);
+    int count = food.getCount();
+
+    // Misses are the common case on a tick
+    std::vector<Position> queries(1024);
+    for (auto& cell : queries) {
+        cell = freeCells.pick(rng);
+    }
+
+    Stopwatch watch;
+    unsigned long long ops = 0;
+    uint64_t hits = 0;
+    while (watch.seconds() < minSeconds) {
+        watch.begin();
+        for (const auto& cell : queries) {
+            hits += food.checkCollision(cell.x, cell.y);
+        }
+        watch.end();
+        ops += queries.size();
+    }
+    report("food_check_collision", grid, param("items", count) + ",miss", ops, watch.seconds());
+
+    // A hit finds the item in the list and erases it; each batch eats up to
+    // 256 random items and the untimed refill puts them back at the end
+    std::vector<Position> eaten(food.getPositions());
+    for (size_t i = eaten.size(); i > 1; i--) {
+        std::swap(eaten[i - 1], eaten[rng.nextBelow(static_cast<int>(i))]);
+    }
+    eaten.resize(std::min<size_t>(256, eaten.size()));
+
+    Stopwatch hitWatch;
+    ops = 0;
+    while (hitWatch.seconds() < minSeconds) {
+        hitWatch.begin();
+        for (const auto& cell : eaten) {
+            hits += food.checkCollision(cell.x, cell.y);
+        }
+        hitWatch.end();
+        ops += eaten.size();
+
+        for (const auto& cell : eaten) {
+            food.spawn(cell.x, cell.y);
+        }
+    }
+    sink = hits;
+    report("food_check_collision", grid, param("items", count) + ",hit", ops, hitWatch.seconds());
+}
+
+void benchGraph(GridSize grid) {
+    Random rng(4);
+    Graph graph(grid.width, grid.height);
+    graph.seed(4);
+
+    int walls = static_cast<int>(std::min<long long>(cellCount(grid) / 10, 1 << 20));
+    std::vector<Position> wallCells = randomCells(grid, walls, rng);
+
+    Stopwatch addWatch, clearWatch;
+    unsigned long long adds = 0, clears = 0;
+    while (addWatch.seconds() < minSeconds || clearWatch.seconds() < minSeconds) {
+        addWatch.begin();
+        for (const auto& cell : wallCells) {
+            graph.addWall(cell.x, cell.y);
+        }
+        addWatch.end();
+        adds += wallCells.size();
+
+        clearWatch.begin();
+        graph.clearWalls();
+        clearWatch.end();
+        clears++;
+    }
+    report("graph_add_wall", grid, param("walls", walls), adds, addWatch.seconds());
+    report("graph_clear_walls", grid, param("walls", walls), clears, clearWatch.seconds());
+
+    // Level 10 is a typical game; the top level fills the 25% wall cap
+    long long topLevel = cellCount(grid) / 12;
+    for (long long level : {10LL, topLevel}) {
+        Stopwatch watch;
+        unsigned long long ops = 0;
+        while (watch.seconds() < minSeconds) {
+            watch.begin();
+            graph.generateWallLevel(static_cast<int>(level));
+            watch.end();
+            ops++;
+        }
+        sink = graph.getWallCount();
+        report("graph_generate_wall_level", grid, param("level", level), ops, watch.seconds());
+    }
+
+    graph.generateWallLevel(10);
+    std::vector<Position> queries = randomCells(grid, 4096, rng);
+    std::pair<int, int> neighbors[4];
+    Stopwatch watch;
+    unsigned long long ops = 0;
+    uint64_t total = 0;
+    while (watch.seconds() < minSeconds) {
+        watch.begin();
+        for (const auto& cell : queries) {
+            total += graph.getValidNeighbors(cell.x, cell.y, neighbors);
+        }
+        watch.end();
+        ops += queries.size();
+    }
+    report("graph_get_valid_neighbors", grid, "buffer", ops, watch.seconds());
+
+    Stopwatch vectorWatch;
+    ops = 0;
+    while (vectorWatch.seconds() < minSeconds) {
+        vectorWatch.begin();
+        for (const auto& cell : queries) {
+            total += graph.getValidNeighbors(cell.x, cell.y).size();
+        }
+        vectorWatch.end();
+        ops += queries.size();
+    }
+    sink = total;
+    report("graph_get_valid_neighbors", grid, "vector", ops, vectorWatch.seconds());
+}
+
+void benchLevels(GridSize grid) {
+    Graph graph(grid.width, grid.height);
+    LevelGenerator generator(grid.width, grid.height);
+    generator.seed(5);
+
+    for (int style = 0; style < LEVEL_STYLE_COUNT; style++) {
+        Stopwatch watch;
+        unsigned long long ops = 0;
+        while (watch.seconds() < minSeconds) {
+            watch.begin();
+            generator.generate(graph, 10, static_cast<LevelStyle>(style));
+            watch.end();
+            ops++;
+        }
+        sink = graph.getWallCount();
+        std::string name = std::string("style=") + LevelGenerator::styleName(static_cast<LevelStyle>(style));
+        report("level_generate", grid, name, ops, watch.seconds());
+    }
+}
+
+void benchScores(GridSize grid) {
+    const int BATCH = 1024;
+    ScoreManager scores;
+    Stopwatch addWatch;
+    unsigned long long ops = 0;
+    while (addWatch.seconds() < minSeconds) {
+        addWatch.begin();
+        for (int i = 0; i < BATCH; i++) {
+            scores.addScore(10);
+        }
+        addWatch.end();
+        ops += BATCH;
+        scores.reset();
+    }
+    report("score_add_score", grid, "", ops, addWatch.seconds());
+
+    Stopwatch overWatch;
+    ops = 0;
+    int round = 0;
+    while (overWatch.seconds() < minSeconds) {
+        scores.reset();
+        scores.addScore((round++ * 37) % 1000);
+        overWatch.begin();
+        scores.gameOver();
+        overWatch.end();
+        ops++;
+    }
+    report("score_game_over", grid, "", ops, overWatch.seconds());
+
+    // Log append + top-K index update, in scratch files
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::string logPath = (directory / "snake_bench_scores.log").string();
+    std::string indexPath = (directory / "snake_bench_scores.idx").string();
+    std::filesystem::remove(logPath);
+    std::filesystem::remove(indexPath);
+    {
+        ScoreStore store;
+        if (store.open(logPath, indexPath)) {
+            Random rng(6);
+            ScoreRecord record;
+            Stopwatch appendWatch;
+            ops = 0;
+            while (appendWatch.seconds() < minSeconds) {
+                appendWatch.begin();
+                for (int i = 0; i < BATCH; i++) {
+                    record.score = rng.nextBelow(100000);
+                    store.append(record);
+                }
+                appendWatch.end();
+                ops += BATCH;
+            }
+            report("score_store_append", grid, param("games", static_cast<long long>(store.getGameCount())), ops,
+                   appendWatch.seconds());
+        }
+    }
+    std::filesystem::remove(logPath);
+    std::filesystem::remove(indexPath);
+}
+
+void benchBatchEnv(GridSize grid) {
+    // Boards are stored whole, so keep the batch to a few tens of MB
+    long long bytesPerBoard = cellCount(grid) * 4 + cellCount(grid) / 8 + 128;
+    if (cellCount(grid) > 256 * 256) return;
+    int boards = static_cast<int>(std::max(1LL, std::min(4096LL, (32LL << 20) / bytesPerBoard)));
+
+    BatchEnv env(boards, grid.width, grid.height);
+    env.reset(8);
+    WorkStealingPool pool;
+    std::vector<int32_t> actions(boards);
+    Random rng(8);
+    for (int threads : {1, pool.getThreadCount()}) {
+        Stopwatch watch;
+        unsigned long long ops = 0;
+        while (watch.seconds() < minSeconds) {
+            // Keep the heading, with an occasional random turn
+            for (int i = 0; i < boards; i++) {
+                actions[i] = rng.nextBelow(8) == 0 ? rng.nextBelow(4) : env.getDirections()[i];
+            }
+            watch.begin();
+            env.step(actions.data(), threads > 1 ? &pool : nullptr);
+            watch.end();
+            ops += boards;
+        }
+        sink = env.getEpisodeCount();
+        report("batch_env_step", grid, param("boards", boards) + "," + param("threads", threads), ops,
+               watch.seconds());
+        if (pool.getThreadCount() == 1) break;
+    }
+}
+
+void benchArena(GridSize grid) {
+    // One snake per 256 cells; ops are moved cells, so flat ns/op across
+    // sizes means the tick scales with the snake count and nothing worse
+    if (cellCount(grid) > 1024 * 1024 || cellCount(grid) < 16 * 256) return;
+    ArenaConfig config;
+    config.width = grid.width;
+    config.height = grid.height;
+    config.snakes = static_cast<int>(cellCount(grid) / 256);
+    Arena arena(config);
+    arena.reset(9);
+
+    Stopwatch watch;
+    unsigned long long before = arena.getStats().moves;
+    while (watch.seconds() < minSeconds) {
+        watch.begin();
+        arena.step();
+        watch.end();
+    }
+    sink = arena.getStats().eaten;
+    report("arena_step", grid, param("snakes", config.snakes), arena.getStats().moves - before, watch.seconds());
+}
+
+bool parseSizes(const std::string& list, std::vector<GridSize>& sizes) {
+    sizes.clear();
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        GridSize grid;
+        if (std::sscanf(item.c_str(), "%dx%d", &grid.width, &grid.height) != 2 ||
+            grid.width < 4 || grid.height < 4 || grid.height % 2 != 0) {
+            return false;
+        }
+        sizes.push_back(grid);
+    }
+    return !sizes.empty();
+}
+
+void writeJson(std::ostream& out) {
+    out << "{\n  \"benchmark\": \"snake_bench\",\n";
+    out << "  \"timestamp\": " << static_cast<long long>(std::time(nullptr)) << ",\n";
+#ifdef NDEBUG
+    out << "  \"optimized\": true,\n";
+#else
+    out << "  \"optimized\": false,\n";
+#endif
+    out << "  \"min_time_s\": " << minSeconds << ",\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        char line[320];
+        std::snprintf(line, sizeof(line),
+                      "    {\"name\": \"%s\", \"width\": %d, \"height\": %d, \"param\": \"%s\", "
+                      "\"ops\": %llu, \"seconds\": %.6f, \"ns_per_op\": %.3f}%s\n",
+                      result.name.c_str(), result.grid.width, result.grid.height, result.param.c_str(),
+                      result.ops, result.seconds, result.seconds * 1e9 / result.ops,
+                      i + 1 < results.size() ? "," : "");
+        out << line;
+    }
+    out << "  ]\n}\n";
+}
+}
+
+int main(int argc, char** argv) {
+    std::vector<GridSize> sizes = {{30, 20}, {256, 256}, {1024, 1024}, {4096, 4096}};
+    std::string outPath;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--sizes" && i + 1 < argc) {
+            if (!parseSizes(argv[++i], sizes)) {
+                std::cerr << "Sizes are WxH lists with even heights, e.g. 30x20,512x512" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            minSeconds = std::atof(argv[++i]);
+        } else if (arg == "--out" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else {
+            std::cerr << "Usage: snake_bench [--sizes WxH,...] [--min-time seconds] [--out file.json]" << std::endl;
+            return 1;
+        }
+    }
+
+    for (const GridSize& grid : sizes) {
+        std::fprintf(stderr, "%dx%d\n", grid.width, grid.height);
+        benchSnake(grid);
+        for (int fill : {10, 50, 90, 99}) {
+            benchFoodSpawn(grid, fill);
+        }
+        benchFoodCollision(grid);
+        benchGraph(grid);
+        benchLevels(grid);
+        benchScores(grid);
+        benchBatchEnv(grid);
+        benchArena(grid);
+    }
+
+    if (outPath.empty()) {
+        writeJson(std::cout);
+    } else {
+        std::ofstream file(outPath);
+        if (!file) {
+            std::cerr << "Failed to write " << outPath << std::endl;
+            return 1;
+        }
+        writeJson(file);
+    }
+    return 0;
+}
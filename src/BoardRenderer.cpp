@@ -0,0 +1,398 @@
+#include "BoardRenderer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const sf::Color BODY_COLOR(100, 255, 100);
+const sf::Color HEAD_COLOR(0, 255, 0);
+}
+
+BoardRenderer::BoardRenderer(int cellSize) :
+    cellSize(cellSize),
+    staticLayer(sf::Triangles),
+    staticOffscreen(false),
+    staticCacheEnabled(true),
+    snakeQuads(sf::Triangles),
+    foodQuads(sf::Triangles),
+    foodTexture(nullptr),
+    profiler(nullptr),
+    staticBuilt(false),
+    builtGraph(nullptr),
+    builtRevision(0),
+    builtTick(0),
+    builtLength(-1),
+    snakeRing(false),
+    builtSnake(nullptr),
+    builtRingMask(0),
+    quadMask(0),
+    drawnFirst(0),
+    drawnHead(0),
+    foodBuilt(false),
+    builtFoodRevision(0),
+    builtArena(nullptr),
+    builtArenaTick(0) {}
+
+void BoardRenderer::setFoodTexture(const sf::Texture* texture) {
+    foodTexture = texture;
+    foodBuilt = false;
+    foodQuads.clear();
+}
+
+void BoardRenderer::appendQuad(sf::VertexArray& quads, float x, float y, float w, float h, sf::Color color) {
+    // Two triangles per quad (sf::Quads is gone in newer SFML)
+    sf::Vector2f topLeft(x, y), topRight(x + w, y), bottomRight(x + w, y + h), bottomLeft(x, y + h);
+    quads.append(sf::Vertex(topLeft, color));
+    quads.append(sf::Vertex(topRight, color));
+    quads.append(sf::Vertex(bottomRight, color));
+    quads.append(sf::Vertex(topLeft, color));
+    quads.append(sf::Vertex(bottomRight, color));
+    quads.append(sf::Vertex(bottomLeft, color));
+}
+
+BoardRenderer::CellRange BoardRenderer::cellsIn(const sf::FloatRect& area, int gridWidth, int gridHeight) const {
+    CellRange range;
+    range.left = std::max(0, static_cast<int>(std::floor(area.left / cellSize)));
+    range.top = std::max(0, static_cast<int>(std::floor(area.top / cellSize)));
+    range.right = std::min(gridWidth, static_cast<int>(std::ceil((area.left + area.width) / cellSize)));
+    range.bottom = std::min(gridHeight, static_cast<int>(std::ceil((area.top + area.height) / cellSize)));
+    range.right = std::max(range.right, range.left);
+    range.bottom = std::max(range.bottom, range.top);
+    return range;
+}
+
+void BoardRenderer::rebuildStatic(const Graph& graph, const CellRange& range) {
+    float left = static_cast<float>(range.left * cellSize);
+    float top = static_cast<float>(range.top * cellSize);
+    float width = static_cast<float>((range.right - range.left) * cellSize);
+    float height = static_cast<float>((range.bottom - range.top) * cellSize);
+    sf::Color lineColor(35, 35, 35);
+    sf::Color wallColor(80, 80, 80);
+
+    staticLayer.clear();
+    appendQuad(staticLayer, left, top, width, height, sf::Color(10, 10, 10));
+    for (int x = range.left; x <= range.right; x++) {
+        appendQuad(staticLayer, static_cast<float>(x * cellSize), top, 1, height, lineColor);
+    }
+    for (int y = range.top; y <= range.bottom; y++) {
+        appendQuad(staticLayer, left, static_cast<float>(y * cellSize), width, 1, lineColor);
+    }
+    for (int y = range.top; y < range.bottom; y++) {
+        for (int x = range.left; x < range.right; x++) {
+            if (graph.isWall(x, y)) {
+                appendQuad(staticLayer, static_cast<float>(x * cellSize), static_cast<float>(y * cellSize),
+                           static_cast<float>(cellSize), static_cast<float>(cellSize), wallColor);
+            }
+        }
+    }
+
+    // Bake the layer into the offscreen texture, which only ever grows
+    unsigned textureWidth = static_cast<unsigned>(width) + 1;
+    unsigned textureHeight = static_cast<unsigned>(height) + 1;
+    sf::Vector2u current = staticTexture.getSize();
+    if (current.x < textureWidth || current.y < textureHeight) {
+        staticOffscreen = staticTexture.create(std::max(current.x, textureWidth), std::max(current.y, textureHeight));
+        if (staticOffscreen) {
+            staticSprite.setTexture(staticTexture.getTexture(), true);
+        }
+    }
+    if (staticOffscreen) {
+        sf::Vector2u size = staticTexture.getSize();
+        staticTexture.setView(sf::View(sf::FloatRect(left, top, static_cast<float>(size.x), static_cast<float>(size.y))));
+        staticTexture.clear(sf::Color::Black);
+        staticTexture.draw(staticLayer);
+        staticTexture.display();
+        staticSprite.setTextureRect(sf::IntRect(0, 0, static_cast<int>(textureWidth), static_cast<int>(textureHeight)));
+        staticSprite.setPosition(left, top);
+    }
+
+    staticBuilt = true;
+    staticRange = range;
+    builtGraph = &graph;
+    builtRevision = graph.getRevision();
+    stats.staticRebuilds++;
+}
+
+void BoardRenderer::writeSlot(int ringIndex, const SnakeSegment& cell, sf::Color color) {
+    std::size_t first = static_cast<std::size_t>(ringIndex & quadMask) * 6;
+    for (std::size_t v = first; v < first + 6; v++) snakeQuads[v].color = color;
+    placeSegmentQuad(first, cell, cell, 0);
+    coverSlot(ringIndex, cell);
+}
+
+void BoardRenderer::coverSlot(int ringIndex, const SnakeSegment& cell) {
+    chunkRanges[(ringIndex & quadMask) / SNAKE_CHUNK].cover(cell.x, cell.y);
+}
+
+void BoardRenderer::clearSlot(int ringIndex) {
+    std::size_t first = static_cast<std::size_t>(ringIndex & quadMask) * 6;
+    for (std::size_t v = first; v < first + 6; v++) snakeQuads[v] = sf::Vertex();
+}
+
+void BoardRenderer::rebuildSnake(const Snake& snake) {
+    SnakeBodyView body = snake.getBody();
+
+    // One spare slot for the vacated tail quad, and a chunk's worth more so
+    // the chunk the head moves into holds nothing live
+    int slots = MIN_SNAKE_SLOTS;
+    while (slots < body.size() + SNAKE_CHUNK) slots *= 2;
+    quadMask = slots - 1;
+    snakeQuads.clear();
+    snakeQuads.resize(static_cast<std::size_t>(slots) * 6);
+    chunkRanges.assign(slots / SNAKE_CHUNK, CellRange());
+
+    for (int i = body.size() - 1; i >= 1; i--) writeSlot(body.ringIndex(i), body[i], BODY_COLOR);
+    writeSlot(body.ringIndex(0), body[0], HEAD_COLOR);
+    drawnFirst = body.ringIndex(body.size() - 1);
+    if (snake.hasVacatedCell()) {
+        drawnFirst = (drawnFirst - 1) & body.ringMask();
+        writeSlot(drawnFirst, snake.getVacatedCell(), BODY_COLOR);
+    }
+    drawnHead = body.ringIndex(0);
+
+    snakeRing = true;
+    builtSnake = &snake;
+    builtRingMask = body.ringMask();
+    stats.snakeRebuilds++;
+}
+
+// Catch the ring up with `steps` moves: new head quads are written and the
+// quads behind the new tail retired. False when the snake was reset, its
+// ring grew, or it outgrew the quad ring; the caller then rebuilds.
+bool BoardRenderer::advanceSnake(const Snake& snake, unsigned long long steps) {
+    SnakeBodyView body = snake.getBody();
+    int mask = body.ringMask();
+    if (!snakeRing || &snake != builtSnake || mask != builtRingMask || body.size() + SNAKE_CHUNK > quadMask + 1) return false;
+    if (steps == 0 || steps >= static_cast<unsigned long long>(body.size())) return false;
+    int moved = static_cast<int>(steps);
+    if (((body.ringIndex(0) - drawnHead) & mask) != moved) return false;
+
+    int first = body.ringIndex(body.size() - 1);
+    if (snake.hasVacatedCell()) first = (first - 1) & mask;
+    int retired = (first - drawnFirst) & mask;
+    if (retired > moved + 1) return false;
+
+    for (int r = 0; r < retired; r++) clearSlot(drawnFirst + r);
+    // The old head (segment `moved`) was interpolated and is drawn as body
+    // now. A chunk the head enters starts its bounds afresh.
+    for (int i = moved; i >= 0; i--) {
+        int slot = body.ringIndex(i);
+        if (i < moved && (slot & (SNAKE_CHUNK - 1)) == 0) chunkRanges[(slot & quadMask) / SNAKE_CHUNK] = CellRange();
+        writeSlot(slot, body[i], i == 0 ? HEAD_COLOR : BODY_COLOR);
+    }
+    if (snake.hasVacatedCell()) writeSlot(first, snake.getVacatedCell(), BODY_COLOR);
+
+    drawnFirst = first;
+    drawnHead = body.ringIndex(0);
+    return true;
+}
+
+void BoardRenderer::placeSegmentQuad(std::size_t firstVertex, const SnakeSegment& from,
+                                     const SnakeSegment& to, float alpha) {
+    float size = static_cast<float>(cellSize - 2);
+    float x = (from.x + (to.x - from.x) * alpha) * cellSize + 1;
+    float y = (from.y + (to.y - from.y) * alpha) * cellSize + 1;
+
+    sf::Vector2f topLeft(x, y), topRight(x + size, y);
+    sf::Vector2f bottomRight(x + size, y + size), bottomLeft(x, y + size);
+    snakeQuads[firstVertex + 0].position = topLeft;
+    snakeQuads[firstVertex + 1].position = topRight;
+    snakeQuads[firstVertex + 2].position = bottomRight;
+    snakeQuads[firstVertex + 3].position = topLeft;
+    snakeQuads[firstVertex + 4].position = bottomRight;
+    snakeQuads[firstVertex + 5].position = bottomLeft;
+}
+
+void BoardRenderer::interpolateSnake(float alpha) {
+    if (!snakeRing) return;
+
+    // Tail first: on a one-segment snake that did not move off its cell the
+    // two slots are the same and the head must win
+    placeSegmentQuad(static_cast<std::size_t>(drawnFirst & quadMask) * 6, tailFrom, tailTo, alpha);
+    placeSegmentQuad(static_cast<std::size_t>(drawnHead & quadMask) * 6, headFrom, headTo, alpha);
+}
+
+void BoardRenderer::appendFoodQuad(int cellX, int cellY) {
+    sf::Vector2u textureSize = foodTexture->getSize();
+    sf::Vector2f t0(0, 0), t1(static_cast<float>(textureSize.x), 0);
+    sf::Vector2f t2(static_cast<float>(textureSize.x), static_cast<float>(textureSize.y));
+    sf::Vector2f t3(0, static_cast<float>(textureSize.y));
+    float s = static_cast<float>(cellSize);
+    float x = static_cast<float>(cellX * cellSize);
+    float y = static_cast<float>(cellY * cellSize);
+    foodQuads.append(sf::Vertex(sf::Vector2f(x, y), t0));
+    foodQuads.append(sf::Vertex(sf::Vector2f(x + s, y), t1));
+    foodQuads.append(sf::Vertex(sf::Vector2f(x + s, y + s), t2));
+    foodQuads.append(sf::Vertex(sf::Vector2f(x, y), t0));
+    foodQuads.append(sf::Vertex(sf::Vector2f(x + s, y + s), t2));
+    foodQuads.append(sf::Vertex(sf::Vector2f(x, y + s), t3));
+}
+
+void BoardRenderer::rebuildFood(const Food& food, const CellRange& range) {
+    foodQuads.clear();
+    foodBuilt = true;
+    builtFoodRevision = food.getRevision();
+    foodRange = range;
+    if (!foodTexture) return;
+
+    const std::vector<Position>& positions = food.getPositions();
+    if (static_cast<long long>(positions.size()) <= range.area()) {
+        for (const auto& position : positions) {
+            if (range.contains(position.x, position.y)) appendFoodQuad(position.x, position.y);
+        }
+    } else {
+        for (int y = range.top; y < range.bottom; y++) {
+            for (int x = range.left; x < range.right; x++) {
+                if (food.contains(x, y)) appendFoodQuad(x, y);
+            }
+        }
+    }
+}
+
+void BoardRenderer::rebuildArena(const Arena& arena, const CellRange& range) {
+    // One pass over the visible cells; each snake gets a colour from its
+    // index, the player's is green and heads are drawn brighter
+    float size = static_cast<float>(cellSize - 2);
+    const std::vector<ArenaSnake>& snakes = arena.getSnakes();
+    snakeQuads.clear();
+    foodQuads.clear();
+    for (int y = range.top; y < range.bottom; y++) {
+        for (int x = range.left; x < range.right; x++) {
+            int owner = arena.getOwner(x, y);
+            if (owner >= 0) {
+                bool head = arena.cellX(snakes[owner].head) == x && arena.cellY(snakes[owner].head) == y;
+                uint32_t hue = static_cast<uint32_t>(owner) * 2654435761u;
+                sf::Color color = owner == arena.getPlayerSnake()
+                                      ? sf::Color(100, 255, 100)
+                                      : sf::Color(96 + (hue >> 24) % 128, 64 + (hue >> 16) % 96, 96 + (hue >> 8) % 128);
+                if (head) color = owner == arena.getPlayerSnake() ? sf::Color::Green : sf::Color::White;
+                appendQuad(snakeQuads, static_cast<float>(x * cellSize + 1), static_cast<float>(y * cellSize + 1), size,
+                           size, color);
+            } else if (foodTexture && arena.hasFood(x, y)) {
+                appendFoodQuad(x, y);
+            }
+        }
+    }
+    stats.drawnSegments = static_cast<int>(snakeQuads.getVertexCount() / 6);
+    builtArena = &arena;
+    builtArenaTick = arena.getTick();
+    snakeRange = range;
+    // The single-snake batches must rebuild when play switches back
+    snakeRing = false;
+    foodBuilt = false;
+}
+
+void BoardRenderer::updateStatic(const Graph& graph, const sf::FloatRect& visible, const CellRange& view) {
+    if (!staticBuilt || &graph != builtGraph || graph.getRevision() != builtRevision || !staticRange.contains(view)) {
+        ProfileScope scope(profiler, PHASE_DRAW_WALLS);
+        float margin = static_cast<float>(STATIC_MARGIN * cellSize);
+        sf::FloatRect padded(visible.left - margin, visible.top - margin,
+                             visible.width + 2 * margin, visible.height + 2 * margin);
+        rebuildStatic(graph, cellsIn(padded, graph.getWidth(), graph.getHeight()));
+    }
+}
+
+void BoardRenderer::update(const Simulation& simulation, float alpha, const sf::FloatRect& visible) {
+    const Graph& graph = simulation.getGraph();
+    CellRange view = cellsIn(visible, graph.getWidth(), graph.getHeight());
+    updateStatic(graph, visible, view);
+    builtArena = nullptr;
+
+    const Snake& snake = simulation.getSnake();
+    {
+        ProfileScope scope(profiler, PHASE_DRAW_SNAKE);
+        SnakeSegment head = snake.getHead();
+        unsigned long long tick = simulation.getTickCount();
+        bool moved = !snakeRing || tick != builtTick || snake.getLength() != builtLength ||
+                     head.x != builtHead.x || head.y != builtHead.y;
+        if (moved) {
+            if (tick < builtTick || !advanceSnake(snake, tick - builtTick)) rebuildSnake(snake);
+
+            SnakeBodyView body = snake.getBody();
+            headTo = body[0];
+            headFrom = body.size() > 1 ? body[1] : body[0];
+            tailTo = body[body.size() - 1];
+            tailFrom = snake.hasVacatedCell() ? snake.getVacatedCell() : tailTo;
+            // The interpolated quads slide across into the neighbouring cell
+            coverSlot(drawnHead, headFrom);
+            coverSlot(drawnFirst, tailTo);
+            builtTick = tick;
+            builtHead = head;
+            builtLength = snake.getLength();
+        }
+        if (moved || view != snakeRange) cullSnake(view);
+        interpolateSnake(alpha);
+    }
+
+    const Food& food = simulation.getFood();
+    if (!foodBuilt || food.getRevision() != builtFoodRevision || view != foodRange) {
+        ProfileScope scope(profiler, PHASE_DRAW_FOOD);
+        rebuildFood(food, view);
+    }
+}
+
+void BoardRenderer::updateArena(const Arena& arena, const sf::FloatRect& visible) {
+    const Graph& graph = arena.getGraph();
+    CellRange view = cellsIn(visible, graph.getWidth(), graph.getHeight());
+    updateStatic(graph, visible, view);
+    if (builtArena != &arena || arena.getTick() != builtArenaTick || view != snakeRange) {
+        ProfileScope scope(profiler, PHASE_DRAW_SNAKE);
+        rebuildArena(arena, view);
+    }
+}
+
+void BoardRenderer::draw(sf::RenderTarget& target) {
+    {
+        ProfileScope scope(profiler, PHASE_DRAW_WALLS);
+        sf::Clock staticClock;
+        if (staticOffscreen && staticCacheEnabled) {
+            target.draw(staticSprite);
+        } else {
+            target.draw(staticLayer);
+        }
+        stats.staticDrawMicros = staticClock.getElapsedTime().asMicroseconds();
+    }
+    {
+        ProfileScope scope(profiler, PHASE_DRAW_SNAKE);
+        if (snakeRing) {
+            drawSnakeRing(target);
+        } else {
+            target.draw(snakeQuads);
+        }
+    }
+    if (foodTexture && foodQuads.getVertexCount() > 0) {
+        ProfileScope scope(profiler, PHASE_DRAW_FOOD);
+        target.draw(foodQuads, sf::RenderStates(foodTexture));
+    }
+}
+
+// Walks the chunks of the live slots once per tick or view change, so a
+// frame submits only the visible ones
+void BoardRenderer::cullSnake(const CellRange& view) {
+    // Live slots run from the vacated tail to the head, wrapping at most
+    // once; visible chunks next to each other in the ring share a draw call
+    snakeRuns.clear();
+    stats.drawnSegments = 0;
+    int slot = drawnFirst & quadMask;
+    int live = ((drawnHead - drawnFirst) & quadMask) + 1;
+    while (live > 0) {
+        int count = std::min(live, SNAKE_CHUNK - (slot & (SNAKE_CHUNK - 1)));
+        if (chunkRanges[slot / SNAKE_CHUNK].intersects(view)) {
+            if (!snakeRuns.empty() && snakeRuns.back().first + snakeRuns.back().count == slot) {
+                snakeRuns.back().count += count;
+            } else {
+                snakeRuns.push_back(SlotRun{slot, count});
+            }
+            stats.drawnSegments += count;
+        }
+        slot = (slot + count) & quadMask;
+        live -= count;
+    }
+    snakeRange = view;
+}
+
+void BoardRenderer::drawSnakeRing(sf::RenderTarget& target) {
+    // The head's run is last, so it stays on top
+    for (const SlotRun& run : snakeRuns) {
+        target.draw(&snakeQuads[static_cast<std::size_t>(run.first) * 6], static_cast<std::size_t>(run.count) * 6, sf::Triangles);
+    }
+}
@@ -0,0 +1,147 @@
+#ifndef BOARDRENDERER_H
+#define BOARDRENDERER_H
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <algorithm>
+#include "Simulation.h"
+#include "Arena.h"
+#include "Profiler.h"
+
+struct BoardRenderStats {
+    unsigned long long staticRebuilds = 0;
+    double staticDrawMicros = 0;    // CPU time spent submitting the static layer last frame
+    int drawnSegments = 0;          // Snake quads submitted per frame (the visible chunks)
+    unsigned long long snakeRebuilds = 0;
+};
+
+// Draws the playfield in three batched draw calls: a static layer (background,
+// grid lines, walls), the snake, and the textured food. Each batch is a
+// vertex array rebuilt only when the state it mirrors has changed. The static
+// layer is additionally rendered into an offscreen texture and drawn as a
+// single sprite; it is invalidated by Graph::getRevision().
+//
+// The static and food layers only turn cells inside the visible area (world
+// pixels, usually the camera view) into vertices, so on large boards their
+// cost follows the view size, not the board size. The static layer covers the
+// view plus a margin and is rebuilt when the view leaves that margin.
+//
+// The snake batch is a ring of quads indexed like the Snake's own ring, so a
+// tick writes the new head quad and retires the vacated tail quad instead of
+// rebuilding the body. The ring is split into chunks of SNAKE_CHUNK quads
+// that each keep the cell bounds of what they hold, and only chunks that
+// meet the view are submitted.
+class BoardRenderer {
+private:
+    // Half-open cell rectangle [left, right) x [top, bottom)
+    struct CellRange {
+        int left = 0, top = 0, right = 0, bottom = 0;
+        bool operator==(const CellRange& other) const {
+            return left == other.left && top == other.top && right == other.right && bottom == other.bottom;
+        }
+        bool operator!=(const CellRange& other) const { return !(*this == other); }
+        bool contains(const CellRange& inner) const {
+            return inner.left >= left && inner.top >= top && inner.right <= right && inner.bottom <= bottom;
+        }
+        bool contains(int x, int y) const { return x >= left && x < right && y >= top && y < bottom; }
+        bool intersects(const CellRange& other) const {
+            return left < other.right && other.left < right && top < other.bottom && other.top < bottom;
+        }
+        // Grow to take in a cell; an empty range becomes just that cell
+        void cover(int x, int y) {
+            if (right <= left || bottom <= top) {
+                *this = CellRange{x, y, x + 1, y + 1};
+                return;
+            }
+            left = std::min(left, x);
+            top = std::min(top, y);
+            right = std::max(right, x + 1);
+            bottom = std::max(bottom, y + 1);
+        }
+        long long area() const { return static_cast<long long>(right - left) * (bottom - top); }
+    };
+
+    static const int STATIC_MARGIN = 8;     // Cells baked around the view on each side
+    static const int MIN_SNAKE_SLOTS = 128;
+    static const int SNAKE_CHUNK = 64;      // Quads per culled chunk of the snake ring
+
+    // Consecutive ring slots submitted in one draw call
+    struct SlotRun {
+        int first, count;
+    };
+
+    int cellSize;
+    sf::VertexArray staticLayer;
+    sf::RenderTexture staticTexture;
+    sf::Sprite staticSprite;
+    bool staticOffscreen;           // Render texture created successfully
+    bool staticCacheEnabled;
+    sf::VertexArray snakeQuads;     // Snake ring, or one quad per visible arena cell
+    sf::VertexArray foodQuads;
+    const sf::Texture* foodTexture;
+    Profiler* profiler;             // Optional; rebuild + draw time per batch
+
+    // What each batch was last built from
+    bool staticBuilt;
+    const Graph* builtGraph;
+    unsigned long long builtRevision;
+    CellRange staticRange;
+    BoardRenderStats stats;
+    unsigned long long builtTick;
+    SnakeSegment builtHead;
+    int builtLength;
+    bool snakeRing;                 // snakeQuads holds the single-snake ring
+    const Snake* builtSnake;
+    int builtRingMask;
+    int quadMask;                   // Segment at ring index r is drawn from slot r & quadMask
+    int drawnFirst, drawnHead;      // Ring indices of the oldest quad (vacated tail) and the head
+    std::vector<CellRange> chunkRanges;     // Cells drawn by each chunk of the ring
+    std::vector<SlotRun> snakeRuns;         // Live slots in visible chunks, head last
+    CellRange snakeRange;           // View the snake batch was last culled to
+    bool foodBuilt;
+    unsigned long long builtFoodRevision;
+    CellRange foodRange;
+    const Arena* builtArena;
+    uint32_t builtArenaTick;
+
+    // Endpoints for interpolating between the last two ticks
+    SnakeSegment headFrom, headTo;
+    SnakeSegment tailFrom, tailTo;
+
+    static void appendQuad(sf::VertexArray& quads, float x, float y, float w, float h, sf::Color color);
+    CellRange cellsIn(const sf::FloatRect& area, int gridWidth, int gridHeight) const;
+    void placeSegmentQuad(std::size_t firstVertex, const SnakeSegment& from, const SnakeSegment& to, float alpha);
+    void interpolateSnake(float alpha);
+    void rebuildStatic(const Graph& graph, const CellRange& range);
+    void writeSlot(int ringIndex, const SnakeSegment& cell, sf::Color color);
+    void coverSlot(int ringIndex, const SnakeSegment& cell);
+    void clearSlot(int ringIndex);
+    void rebuildSnake(const Snake& snake);
+    bool advanceSnake(const Snake& snake, unsigned long long steps);
+    void cullSnake(const CellRange& view);
+    void drawSnakeRing(sf::RenderTarget& target);
+    void rebuildFood(const Food& food, const CellRange& range);
+    void appendFoodQuad(int cellX, int cellY);
+    void updateStatic(const Graph& graph, const sf::FloatRect& visible, const CellRange& view);
+    void rebuildArena(const Arena& arena, const CellRange& range);
+
+public:
+    explicit BoardRenderer(int cellSize);
+    void setFoodTexture(const sf::Texture* texture);
+    void setProfiler(Profiler* target) { profiler = target; }
+    // Refresh the batches whose source state (or visible part) changed since
+    // the last call. alpha in [0, 1] is how far the frame is between the
+    // previous tick and the current one; only the head and vacated-tail quads
+    // move with it. visible is the area being drawn, in world pixels.
+    void update(const Simulation& simulation, float alpha, const sf::FloatRect& visible);
+    // Same batches for a many-snake arena, rebuilt from the visible cells of
+    // its ownership grid after every tick (no interpolation)
+    void updateArena(const Arena& arena, const sf::FloatRect& visible);
+    void draw(sf::RenderTarget& target);
+    // Draw the static layer from its vertex array every frame instead (for comparison)
+    void setStaticCacheEnabled(bool enabled) { staticCacheEnabled = enabled; }
+    bool isStaticCacheEnabled() const { return staticCacheEnabled; }
+    const BoardRenderStats& getStats() const { return stats; }
+};
+
+#endif
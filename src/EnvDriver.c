@@ -0,0 +1,138 @@
+#include "SnakeEnv.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Small C client of the snake_env library: plays games with a greedy policy
+ * that sees only the observation planes, and checks every frame against its
+ * header (one head, length body cells, food_count food cells).
+ *   snake_env_driver [--games N] [--grid WxH] [--frames N] [--shared path] [--show]
+ * Exits non-zero if a frame is inconsistent. */
+
+static int countCells(const uint8_t* plane, int cells, int value) {
+    int count = 0;
+    for (int i = 0; i < cells; i++) {
+        if (plane[i] == value) count++;
+    }
+    return count;
+}
+
+/* Cheapest safe move toward the nearest food, by Manhattan distance */
+static int choose(const SnakeEnvRing* ring, const SnakeEnvFrame* frame) {
+    static const int dx[4] = { 0, 0, -1, 1 };
+    static const int dy[4] = { -1, 1, 0, 0 };
+    int width = (int)ring->width;
+    int height = (int)ring->height;
+    const uint8_t* walls = snake_env_plane(ring, frame, SNAKE_ENV_PLANE_WALL);
+    const uint8_t* body = snake_env_plane(ring, frame, SNAKE_ENV_PLANE_BODY);
+    const uint8_t* food = snake_env_plane(ring, frame, SNAKE_ENV_PLANE_FOOD);
+    int best = SNAKE_ENV_KEEP;
+    int bestDistance = 1 << 30;
+
+    for (int action = SNAKE_ENV_UP; action <= SNAKE_ENV_RIGHT; action++) {
+        int x = frame->head_x + dx[action];
+        int y = frame->head_y + dy[action];
+        if (x < 0 || x >= width || y < 0 || y >= height) continue;
+        if (walls[y * width + x] || body[y * width + x]) continue;
+        int distance = width + height;
+        for (int cell = 0; cell < width * height; cell++) {
+            if (!food[cell]) continue;
+            int d = abs(cell % width - x) + abs(cell / width - y);
+            if (d < distance) distance = d;
+        }
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = action;
+        }
+    }
+    return best;
+}
+
+static void show(const SnakeEnvRing* ring, const SnakeEnvFrame* frame) {
+    int width = (int)ring->width;
+    const uint8_t* walls = snake_env_plane(ring, frame, SNAKE_ENV_PLANE_WALL);
+    const uint8_t* body = snake_env_plane(ring, frame, SNAKE_ENV_PLANE_BODY);
+    const uint8_t* food = snake_env_plane(ring, frame, SNAKE_ENV_PLANE_FOOD);
+    for (uint32_t y = 0; y < ring->height; y++) {
+        for (int x = 0; x < width; x++) {
+            int cell = (int)y * width + x;
+            putchar(walls[cell] ? '#' : body[cell] == 2 ? '@' : body[cell] ? 'o' : food[cell] ? '*' : '.');
+        }
+        putchar('\n');
+    }
+    printf("score %d, level %d, length %d, tick %llu\n", frame->score, frame->level, frame->length,
+           (unsigned long long)frame->tick);
+}
+
+int main(int argc, char** argv) {
+    SnakeEnvConfig config = { 30, 20, 3, 0, 4 };
+    int games = 20;
+    int display = 0;
+    const char* sharedPath = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            games = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &config.width, &config.height) != 2) return 1;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            config.frame_count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--shared") == 0 && i + 1 < argc) {
+            sharedPath = argv[++i];
+        } else if (strcmp(argv[i], "--show") == 0) {
+            display = 1;
+        } else {
+            fprintf(stderr, "Usage: snake_env_driver [--games N] [--grid WxH] [--frames N] [--shared path] [--show]\n");
+            return 1;
+        }
+    }
+
+    /* The ring lives in our own buffer unless a shared mapping is asked for */
+    size_t size = snake_env_buffer_size(&config);
+    void* buffer = NULL;
+    SnakeEnv* env = NULL;
+    if (sharedPath) {
+        env = snake_env_create_shared(&config, sharedPath);
+    } else if (size > 0 && (buffer = malloc(size)) != NULL) {
+        env = snake_env_create(&config, buffer, size);
+    }
+    if (!env) {
+        fprintf(stderr, "Could not create the environment\n");
+        free(buffer);
+        return 1;
+    }
+
+    const SnakeEnvRing* ring = snake_env_ring(env);
+    int cells = config.width * config.height;
+    unsigned long long steps = 0;
+    long long totalScore = 0;
+    int bad = 0;
+    clock_t started = clock();
+
+    for (int game = 0; game < games; game++) {
+        const SnakeEnvFrame* frame = snake_env_reset(env, 1000 + (uint64_t)game);
+        while (frame->alive && frame->tick < 20000) {
+            frame = snake_env_step(env, choose(ring, frame));
+            steps++;
+
+            const uint8_t* body = snake_env_plane(ring, frame, SNAKE_ENV_PLANE_BODY);
+            const uint8_t* food = snake_env_plane(ring, frame, SNAKE_ENV_PLANE_FOOD);
+            if (frame->sequence != ring->latest || snake_env_ring_frame(ring, ring->latest) != frame) bad++;
+            if (frame->alive && (countCells(body, cells, 2) != 1 || countCells(body, cells, 1) != frame->length - 1 ||
+                                 countCells(food, cells, 1) != frame->food_count)) {
+                bad++;
+            }
+        }
+        totalScore += frame->score;
+        if (display && game == games - 1) show(ring, frame);
+    }
+
+    double seconds = (double)(clock() - started) / CLOCKS_PER_SEC;
+    printf("%d games, %llu steps, mean score %.1f, %.2f us/step (policy included), %d bad frames\n", games, steps,
+           games > 0 ? (double)totalScore / games : 0.0, steps > 0 ? seconds * 1e6 / steps : 0.0, bad);
+
+    snake_env_close(env);
+    free(buffer);
+    return bad == 0 ? 0 : 1;
+}
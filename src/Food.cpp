@@ -1,92 +1,77 @@
 #include "Food.h"
 #include <algorithm>
-#include <iostream>
-#include <SFML/Graphics.hpp>
-Food::Food(int maxFoodCount) : maxFood(maxFoodCount), rng(std::random_device{}()) {}
+#include <random>
+
+Food::Food(int maxFoodCount, int gridWidth, int gridHeight) :
+    gridWidth(gridWidth), gridHeight(gridHeight), rng(std::random_device{}()),
+    maxFood(maxFoodCount), revision(0) {
+    occupancy.assign((static_cast<size_t>(gridWidth) * gridHeight + 63) / 64, 0);
+}
+
+void Food::setCell(int x, int y, bool occupied) {
+    if (!inGrid(x, y)) return;
+    size_t index = static_cast<size_t>(y) * gridWidth + x;
+    uint64_t bit = uint64_t(1) << (index & 63);
+    if (occupied) occupancy[index >> 6] |= bit;
+    else occupancy[index >> 6] &= ~bit;
+}
 
 void Food::spawn(int x, int y) {
     if (foodPositions.size() < maxFood) {
-        foodPositions.push_back(sf::Vector2i(x, y));
+        foodPositions.push_back(Position(x, y));
+        setCell(x, y, true);
+        revision++;
     }
 }
 
-bool Food::loadTexture(const std::string& path) {
-    if (!foodTexture.loadFromFile(path)) {
-        std::cout << "Failed to load food texture: " << path << std::endl;
-        return false;
+bool Food::spawnRandom(FreeCellSet& freeCells) {
+    while (foodPositions.size() < maxFood) {
+        if (freeCells.empty()) {
+            return false;
+        }
+
+        // Uniform over the free cells, and a function of the board and RNG only
+        Position cell = freeCells.pick(rng);
+        freeCells.erase(cell.x, cell.y);
+        foodPositions.push_back(cell);
+        setCell(cell.x, cell.y, true);
+        revision++;
     }
-    foodSprite.setTexture(foodTexture);
     return true;
 }
 
-void Food::spawnRandom(int gridWidth, int gridHeight, 
-                      const std::vector<sf::Vector2i>& occupiedPositions) {
-    while (foodPositions.size() < maxFood) {
-        int x = rng() % gridWidth;
-        int y = rng() % gridHeight;
-
-        // Check is position not occupied
-        bool occupied = false;
-        for (const auto& pos : occupiedPositions) {
-            if (pos.x == x && pos.y == y) {
-                occupied = true;
-                break;
-            }
-        }
-        
-        // Check food exist
-        for (const auto& food : foodPositions) {
-            if (food.x == x && food.y == y) {
-                occupied = true;
-                break;
-            }
-        }
-        
-        if (!occupied) {
-            foodPositions.push_back(sf::Vector2i(x, y));
-        }
+bool Food::contains(int x, int y) const {
+    if (gridWidth > 0) {
+        if (!inGrid(x, y)) return false;
+        size_t index = static_cast<size_t>(y) * gridWidth + x;
+        return (occupancy[index >> 6] >> (index & 63)) & 1;
     }
+    return std::any_of(foodPositions.begin(), foodPositions.end(),
+                       [x, y](const Position& food) { return food.x == x && food.y == y; });
 }
 
 bool Food::checkCollision(int x, int y) {
+    // Most ticks miss; the bitset answers those without scanning the list
+    if (gridWidth > 0 && !contains(x, y)) return false;
+
     auto it = std::find_if(foodPositions.begin(), foodPositions.end(),
-                          [x, y](const sf::Vector2i& food) {
+                          [x, y](const Position& food) {
                               return food.x == x && food.y == y;
                           });
     
     if (it != foodPositions.end()) {
         foodPositions.erase(it);
+        setCell(x, y, false);
+        revision++;
         return true;
     }
     return false;
 }
 
-/*void Food::render(sf::RenderWindow& window, int cellSize) const {
-    sf::CircleShape foodShape(cellSize / 2 - 2);
-    foodShape.setFillColor(sf::Color::Red);
-    
-    for (const auto& food : foodPositions) {
-        foodShape.setPosition(food.x * cellSize + 2, food.y * cellSize + 2);
-        window.draw(foodShape);
-    }
-}*/
-
-void Food::render(sf::RenderWindow& window, int cellSize)  {
-    if (foodTexture.getSize().x == 0 || foodTexture.getSize().y == 0) {
-    std::cerr << "Error: Food texture not loaded or empty!" << std::endl;
-    return;
-}
-
-    for (const auto& food : foodPositions) {
-        foodSprite.setPosition(food.x * cellSize, food.y * cellSize);
-        foodSprite.setScale(
-            static_cast<float>(cellSize) / foodTexture.getSize().x,
-            static_cast<float>(cellSize) / foodTexture.getSize().y
-        );
-        window.draw(foodSprite);
-    }
-}
-
 void Food::clear() {
+    for (const auto& position : foodPositions) {
+        setCell(position.x, position.y, false);
+    }
     foodPositions.clear();
-}
\ No newline at end of file
+    revision++;
+}
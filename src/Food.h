@@ -1,28 +1,42 @@
 #ifndef FOOD_H
 #define FOOD_H
 
-#include <SFML/Graphics.hpp>
 #include <vector>
-#include <random>
+#include <cstdint>
+#include "Position.h"
+#include "FreeCellSet.h"
+#include "Random.h"
 
 class Food {
 private:
-    std::vector<sf::Vector2i> foodPositions;
-    std::mt19937 rng;
+    std::vector<Position> foodPositions;
+    std::vector<uint64_t> occupancy;    // One bit per cell when the grid size is known
+    int gridWidth, gridHeight;
+    Random rng;
     int maxFood;
-    sf::Texture foodTexture; // New: texture for the food icon
-    sf::Sprite foodSprite;   // New: sprite used for drawing
+    unsigned long long revision;        // Bumped whenever foodPositions changes
+
+    bool inGrid(int x, int y) const { return x >= 0 && x < gridWidth && y >= 0 && y < gridHeight; }
+    void setCell(int x, int y, bool occupied);
 public:
-    Food(int maxFoodCount = 3);
+    // With a grid size, collision tests are O(1) bit lookups; without one
+    // they scan the food list
+    Food(int maxFoodCount = 3, int gridWidth = 0, int gridHeight = 0);
+    // Restart the spawn sequence; the same seed gives the same food placements
+    void seed(uint64_t value) { rng.seed(value); }
+    uint64_t getRngState() const { return rng.getState(); }
+    void setRngState(uint64_t state) { rng.setState(state); }
     void spawn(int x, int y);
-    void spawnRandom(int gridWidth, int gridHeight, 
-                    const std::vector<sf::Vector2i>& occupiedPositions);
+    // Tops food up to the maximum, taking cells out of freeCells. Returns
+    // false if the board ran out of free cells first.
+    bool spawnRandom(FreeCellSet& freeCells);
     bool checkCollision(int x, int y);
-    void render(sf::RenderWindow& window, int cellSize);
+    bool contains(int x, int y) const;
     void clear();
-    bool loadTexture(const std::string& path);
     int getCount() const { return foodPositions.size(); }
-    std::vector<sf::Vector2i> getPositions() const { return foodPositions; }
+    int getMaxCount() const { return maxFood; }
+    const std::vector<Position>& getPositions() const { return foodPositions; }
+    unsigned long long getRevision() const { return revision; }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,125 @@
+#include "FreeCellSet.h"
+#include <algorithm>
+#include <cstddef>
+
+namespace {
+// BYTE_SELECT.bit[b][r]: position of the r-th set bit of byte b
+struct ByteSelectTable {
+    uint8_t bit[256][8];
+};
+
+constexpr ByteSelectTable makeByteSelectTable() {
+    ByteSelectTable table{};
+    for (int value = 0; value < 256; value++) {
+        int rank = 0;
+        for (int bit = 0; bit < 8; bit++) {
+            if ((value >> bit) & 1) table.bit[value][rank++] = static_cast<uint8_t>(bit);
+        }
+    }
+    return table;
+}
+
+constexpr ByteSelectTable BYTE_SELECT = makeByteSelectTable();
+
+// Position of the rank-th set bit of word: per-byte popcounts and their
+// running sums pick the byte, then a table the bit within it
+int selectInWord(uint64_t word, int rank) {
+    uint64_t counts = word - ((word >> 1) & 0x5555555555555555ULL);
+    counts = (counts & 0x3333333333333333ULL) + ((counts >> 2) & 0x3333333333333333ULL);
+    counts = (counts + (counts >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    uint64_t sums = counts * 0x0101010101010101ULL;     // Byte i: set bits in bytes 0..i
+
+    // Sums only grow, so the bytes whose sum is <= rank form a prefix; its
+    // length (found without branching) is the byte holding the bit
+    uint64_t atMost = ((static_cast<uint64_t>(rank) * 0x0101010101010101ULL | 0x8080808080808080ULL) - sums)
+                      & 0x8080808080808080ULL;
+    int byte = static_cast<int>(((atMost >> 7) * 0x0101010101010101ULL) >> 56);
+    rank -= static_cast<int>(((sums << 8) >> (byte * 8)) & 0xFF);
+    return byte * 8 + BYTE_SELECT.bit[(word >> (byte * 8)) & 0xFF][rank];
+}
+}
+
+FreeCellSet::FreeCellSet(int width, int height) : width(width), height(height), count(0) {
+    size_t words = (static_cast<size_t>(width) * height + 63) / 64;
+    bits.assign(words, 0);
+    tree.assign(words + 1, 0);
+    treeStep = 1;
+    while (static_cast<size_t>(treeStep) * 2 <= words) treeStep *= 2;
+}
+
+void FreeCellSet::addToWord(int word, int delta) {
+    for (int i = word + 1; i < static_cast<int>(tree.size()); i += i & -i) {
+        tree[i] += delta;
+    }
+}
+
+void FreeCellSet::fill() {
+    int cellCount = width * height;
+    int words = static_cast<int>(bits.size());
+    for (int word = 0; word < words; word++) {
+        int used = std::min(64, cellCount - word * 64);
+        bits[word] = used == 64 ? ~uint64_t(0) : (uint64_t(1) << used) - 1;
+        tree[word + 1] = used;
+    }
+    // Linear-time Fenwick build: push each node's total into its parent
+    for (int i = 1; i <= words; i++) {
+        int parent = i + (i & -i);
+        if (parent <= words) tree[parent] += tree[i];
+    }
+    count = cellCount;
+}
+
+void FreeCellSet::insert(int x, int y) {
+    if (!inGrid(x, y)) return;
+
+    size_t cell = static_cast<size_t>(y) * width + x;
+    uint64_t mask = uint64_t(1) << (cell & 63);
+    if (bits[cell >> 6] & mask) return;
+    bits[cell >> 6] |= mask;
+    addToWord(static_cast<int>(cell >> 6), 1);
+    count++;
+}
+
+void FreeCellSet::erase(int x, int y) {
+    if (!inGrid(x, y)) return;
+
+    size_t cell = static_cast<size_t>(y) * width + x;
+    uint64_t mask = uint64_t(1) << (cell & 63);
+    if (!(bits[cell >> 6] & mask)) return;
+    bits[cell >> 6] &= ~mask;
+    addToWord(static_cast<int>(cell >> 6), -1);
+    count--;
+}
+
+bool FreeCellSet::contains(int x, int y) const {
+    if (!inGrid(x, y)) return false;
+    size_t cell = static_cast<size_t>(y) * width + x;
+    return (bits[cell >> 6] >> (cell & 63)) & 1;
+}
+
+Position FreeCellSet::pick(Random& rng) const {
+    int cellCount = width * height;
+    for (int probe = 0; probe < PICK_PROBES; probe++) {
+        int cell = rng.nextBelow(cellCount);
+        if ((bits[cell >> 6] >> (cell & 63)) & 1) return Position(cell % width, cell / width);
+    }
+    return at(rng.nextBelow(count));
+}
+
+Position FreeCellSet::at(int rank) const {
+    // Descend the tree to the word holding the rank-th free cell...
+    int word = 0;
+    int words = static_cast<int>(bits.size());
+    for (int step = treeStep; step > 0; step >>= 1) {
+        int next = word + step;
+        if (next <= words) {
+            int below = tree[next];
+            bool take = below <= rank;
+            word = take ? next : word;
+            rank -= take ? below : 0;
+        }
+    }
+    // ...then find that set bit within the word
+    int cell = word * 64 + selectInWord(bits[word], rank);
+    return Position(cell % width, cell / width);
+}
@@ -0,0 +1,44 @@
+#ifndef FREECELLSET_H
+#define FREECELLSET_H
+
+#include <vector>
+#include <cstdint>
+#include "Position.h"
+#include "Random.h"
+
+// Set of unoccupied grid cells: one bit per cell plus a Fenwick tree of free
+// counts per 64-cell word, so insert and erase are O(log cells). pick() is a
+// uniform draw that depends only on which cells are free and the RNG, not on
+// the order they were freed in; a game rebuilt from a compact keyframe
+// spawns food where the original did. Coordinates outside the grid are
+// ignored.
+class FreeCellSet {
+private:
+    int width, height;
+    int count;
+    std::vector<uint64_t> bits;     // One bit per cell, set while free
+    std::vector<int> tree;          // Fenwick tree over the words' free counts, 1-based
+    int treeStep;                   // Largest power of two <= bits.size()
+
+    static const int PICK_PROBES = 8;   // Random cells tried before the rank select
+
+    bool inGrid(int x, int y) const { return x >= 0 && x < width && y >= 0 && y < height; }
+    void addToWord(int word, int delta);
+
+public:
+    FreeCellSet(int width, int height);
+    void fill();                // Mark every cell free
+    void insert(int x, int y);
+    void erase(int x, int y);
+    bool contains(int x, int y) const;
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    // The rank-th free cell in row-major order, rank in [0, size())
+    Position at(int rank) const;
+    // Uniform over the free cells; the set must not be empty. Probes random
+    // cells first (O(1) unless the board is nearly full), then falls back to
+    // at() with a fresh draw, which keeps the result uniform.
+    Position pick(Random& rng) const;
+};
+
+#endif
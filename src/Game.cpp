@@ -1,154 +1,263 @@
 #include "Game.h"
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
 #include <SFML/Audio.hpp>
 
-Game::Game() : 
+Game::Game(int width, int height, const std::string& dataDirectory) : 
     window(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "Snake Game with Data Structures"),
-    snake(3, GRID_HEIGHT / 2),
-    food(3),
-    gameGraph(GRID_WIDTH, GRID_HEIGHT),
+    // Food keeps the default board's density: 3 items per 600 cells
+    simulation(width, height, std::max(3, static_cast<int>(static_cast<long long>(width) * height / 200))),
+    autopilot(width, height),
+    hamiltonian(width, height),
+    arenaCameraX(0),
+    arenaCameraY(0),
+    boardRenderer(CELL_SIZE),
     state(MENU),
+    hud(font),
+    firstFrameMillis(0),
+    assetsReported(false),
+    gridWidth(width),
+    gridHeight(height),
+    awaitingPresent(false),
+    pendingKeyMicros(0),
+    frameMillis(0),
+    statsState(MENU),
+    statsDue(true),
     gameSpeed(0.15f),
-    gameRunning(false) {
+    tickAccumulator(0),
+    tickAlpha(1),
+    pacing(PACING_VSYNC),
+    profilerOverlay(false),
+    profileRefreshCountdown(0),
+    gameRunning(false),
+    aiMode(AI_OFF) {
+
+    simulation.setProfiler(&profiler);
+    boardRenderer.setProfiler(&profiler);
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        profileLines[phase][0] = '\0';
+    }
+    frameLine[0] = inputLine[0] = arenaLine[0] = arenaFrameLine[0] = '\0';
     
-    // Background music
-if (!bgMusic.openFromFile("../assets/audio/background.ogg")) {
-    std::cerr << "Failed to load background music" << std::endl;
-} else {
-    bgMusic.setLoop(true);
-    bgMusic.setVolume(10); 
-    bgMusic.play();
-}
-
-// Sound effects
-if (!eatBuffer.loadFromFile("../assets/audio/eat.mp3")) {
-    std::cerr << "Failed to load eat sound" << std::endl;
-} else{
-    eatSound.setBuffer(eatBuffer);
-    eatSound.setVolume(100.0f); 
-}
-if (!collisionBuffer.loadFromFile("../assets/audio/hit.wav")) {
-    std::cerr << "Failed to load collision sound" << std::endl;
-} else {
-    collisionSound.setBuffer(collisionBuffer);
-    collisionSound.setVolume(100.0f); 
-}
-if (!levelBuffer.loadFromFile("../assets/audio/levelup.wav")) {
-    std::cerr << "Failed to load level up sound" << std::endl;
-} else {
-    levelUpSound.setBuffer(levelBuffer);
-    levelUpSound.setVolume(100.0f); 
-}
-
-// Set buffers to sound players
-eatSound.setBuffer(eatBuffer);
-collisionSound.setBuffer(collisionBuffer);
-levelUpSound.setBuffer(levelBuffer);
-
-     if (!food.loadTexture("../assets/images/apple.png")) {
-        std::cerr << "Failed to load apple texture!" << std::endl;
-    }    
-    if (!loadFont()) {
+    // The font is needed for the first frame; everything else decodes in
+    // the background while the menu is up and is hooked up when ready
+    if (!AssetManager::loadFont(font, { "C:/Windows/Fonts/arial.ttf",                       // Windows
+                                        "/System/Library/Fonts/Arial.ttf",                  // macOS
+                                        "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf" })) {
         std::cout << "Warning: Could not load font. Using default font." << std::endl;
     }
-     if (!bgMusic.openFromFile("../assets/audio/background.ogg")) {
-        std::cout << "Failed to load background music" << std::endl;
-    } else {
-        bgMusic.setLoop(true);
-        bgMusic.play();
+    if (!assets.openPack(dataDirectory + "/assets.pak")) {
+        std::cout << "No asset pack in " << dataDirectory << "; loading loose files" << std::endl;
     }
-
-    if (!eatBuffer.loadFromFile("../assets/audio/eat.wav"))
-        std::cout << "Failed to load eat sound" << std::endl;
-    if (!collisionBuffer.loadFromFile("../assets/audio/hit.wav"))
-        std::cout << "Failed to load collision sound" << std::endl;
-    if (!levelBuffer.loadFromFile("../assets/audio/levelup.wav"))
-        std::cout << "Failed to load level up sound" << std::endl;
-
-    eatSound.setBuffer(eatBuffer);
-    collisionSound.setBuffer(collisionBuffer);
-    levelUpSound.setBuffer(levelBuffer);
-
-    
-    window.setFramerateLimit(60);
+    assets.setFallbackDirectory(dataDirectory + "/../assets/");
+    replayPath = dataDirectory + "/last_game.snkr";
+    if (!scoreStore.open(dataDirectory + "/scores.log", dataDirectory + "/scores.idx")) {
+        std::cerr << "Could not open the score log in " << dataDirectory << "; scores will not be saved" << std::endl;
+    }
+    assets.requestMusic({ "audio/background.ogg" }, [](sf::Music& music) {
+        music.setLoop(true);
+        music.setVolume(10);
+        music.play();
+    });
+    assets.requestSound({ "audio/eat.wav", "audio/eat.mp3" }, [this](const sf::SoundBuffer& buffer) {
+        eatSound.setBuffer(buffer);
+    });
+    assets.requestSound({ "audio/hit.wav" }, [this](const sf::SoundBuffer& buffer) {
+        collisionSound.setBuffer(buffer);
+    });
+    assets.requestSound({ "audio/levelup.wav" }, [this](const sf::SoundBuffer& buffer) {
+        levelUpSound.setBuffer(buffer);
+    });
+    assets.requestTexture({ "images/apple.png" }, [this](const sf::Texture& texture) {
+        boardRenderer.setFoodTexture(&texture);
+    });
+
+    applyFramePacing();
     
 }
 
-bool Game::loadFont() {
-    // font
-    return font.loadFromFile("C:/Windows/Fonts/arial.ttf") ||  // Windows
-           font.loadFromFile("/System/Library/Fonts/Arial.ttf") ||  
-           font.loadFromFile("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf"); 
-}
-
-void Game::renderText(const std::string& text, float x, float y, int size, sf::Color color) {
-    sf::Text sfText;
-    sfText.setFont(font);
-    sfText.setString(text);
-    sfText.setCharacterSize(size);
-    sfText.setFillColor(color);
-    sfText.setOutlineColor(sf::Color::Black);
-    sfText.setOutlineThickness(2);
-    sfText.setStyle(sf::Text::Bold);
-    sfText.setPosition(x, y);
-    window.draw(sfText);
+void Game::renderText(sf::RenderTarget& target, const std::string& text, float x, float y, int size, sf::Color color) {
+    hud.drawOnce(target, text, x, y, size, color);
 }
 
 void Game::renderUI() {
-    int uiX = GRID_WIDTH * CELL_SIZE + 10;
-
-    sf::RectangleShape uiPanel;
-    uiPanel.setSize(sf::Vector2f(190, WINDOW_HEIGHT - 20));
-    uiPanel.setPosition(GRID_WIDTH * CELL_SIZE + 5, 10);
-    uiPanel.setFillColor(sf::Color(25, 25, 25, 230));
-    uiPanel.setOutlineColor(sf::Color::White);
-    uiPanel.setOutlineThickness(2);
-    window.draw(uiPanel);
-
-    std::stringstream ss;
-    ss << "Score: " << scoreManager.getCurrentScore();
-    renderText(ss.str(), uiX, 20, 22, sf::Color::White);
+    float uiX = BOARD_PIXEL_WIDTH + 10;
+
+    // Panel background, headings and control help never change
+    sf::FloatRect sidebar(BOARD_PIXEL_WIDTH, 0, WINDOW_WIDTH - BOARD_PIXEL_WIDTH, WINDOW_HEIGHT);
+    hud.drawPanel(window, PANEL_SIDEBAR, 0, sidebar, [this, uiX](sf::RenderTarget& target) {
+        sf::RectangleShape uiPanel;
+        uiPanel.setSize(sf::Vector2f(190, WINDOW_HEIGHT - 20));
+        uiPanel.setPosition(BOARD_PIXEL_WIDTH + 5, 10);
+        uiPanel.setFillColor(sf::Color(25, 25, 25, 230));
+        uiPanel.setOutlineColor(sf::Color::White);
+        uiPanel.setOutlineThickness(2);
+        target.draw(uiPanel);
+
+        renderText(target, "Recent Points:", uiX, 120, 18, sf::Color::Cyan);
+        renderText(target, "Controls:", uiX, 310, 18, sf::Color::Yellow);
+        renderText(target, "WASD: Move", uiX, 335, 14);
+        renderText(target, "P: Pause", uiX, 355, 14);
+        renderText(target, "U: Undo Score", uiX, 375, 14);
+        renderText(target, "I: Cycle AI mode", uiX, 395, 14);
+        renderText(target, "F2: Static layer cache", uiX, 415, 14);
+        renderText(target, "F4: VSync/Uncapped/60", uiX, 435, 14);
+        renderText(target, "F3: Profiler  F6: CSV", uiX, 455, 14);
+    });
+
+    const ScoreManager& scores = simulation.getScoreManager();
+    hud.drawValue(window, HUD_SCORE, "Score: ", scores.getCurrentScore(), uiX, 20, 22, sf::Color::White);
+    hud.drawValue(window, HUD_LEVEL, "Level: ", scores.getCurrentLevel(), uiX, 50, 22, sf::Color::White);
+    hud.drawValue(window, HUD_LENGTH, "Length: ", simulation.getSnake().getLength(), uiX, 80, 22, sf::Color::White);
+
+    RecentScoresView recentScores = scores.getRecentScores();
+    for (int i = 0; i < recentScores.size(); i++) {
+        hud.drawValue(window, HUD_RECENT + i, "+", recentScores[i], uiX, 145 + i * 20, 16, sf::Color::Green);
+    }
 
-    ss.str("");
-    ss << "Level: " << scoreManager.getCurrentLevel();
-    renderText(ss.str(), uiX, 50, 22, sf::Color::White);
+    hud.drawValue(window, HUD_FOOD, "Food: ", simulation.getFood().getCount(), uiX, 260, 22, sf::Color::Red);
+
+    char aiLine[64];
+    if (aiMode == AI_GREEDY) {
+        const AutopilotStats& aiStats = autopilot.getStats();
+        std::snprintf(aiLine, sizeof(aiLine), "AI plan: %.1f us (avg %.1f)",
+                      aiStats.lastMicros, aiStats.averageMicros);
+        hud.drawText(window, HUD_AI, aiLine, uiX, 288, 12, sf::Color::Magenta);
+    } else if (aiMode == AI_HAMILTONIAN) {
+        const HamiltonianStats& cycleStats = hamiltonian.getStats();
+        std::snprintf(aiLine, sizeof(aiLine), "AI cycle: %d cells, %llu shortcuts",
+                      cycleStats.cycleLength, cycleStats.shortcuts);
+        hud.drawText(window, HUD_AI, aiLine, uiX, 288, 12, sf::Color::Magenta);
+    } else if (aiMode == AI_MCTS) {
+        const MctsStats& searchStats = mcts->getStats();
+        std::snprintf(aiLine, sizeof(aiLine), "AI MCTS: %.1f ms, %.0fk rollouts/s/core",
+                      searchStats.lastMillis, searchStats.rolloutsPerSecondPerThread / 1000.0);
+        hud.drawText(window, HUD_AI, aiLine, uiX, 288, 12, sf::Color::Magenta);
+    }
 
-    ss.str("");
-    ss << "Length: " << snake.getLength();
-    renderText(ss.str(), uiX, 80, 22, sf::Color::White);
+    // Frame cost and what the static layer took to submit the last sampled frame
+    if (statsDue) {
+        std::snprintf(frameLine, sizeof(frameLine), "Frame %.2f ms, static %d us%s",
+                      frameMillis, static_cast<int>(boardRenderer.getStats().staticDrawMicros),
+                      boardRenderer.isStaticCacheEnabled() ? "" : " (uncached)");
+        std::snprintf(inputLine, sizeof(inputLine), "Input: tick %.1f ms, frame %.1f ms",
+                      keyToTick.averageMillis, keyToFrame.averageMillis);
+    }
+    hud.drawText(window, HUD_FRAME, frameLine, uiX, 480, 12, sf::Color(160, 160, 160));
+    hud.drawText(window, HUD_INPUT, inputLine, uiX, 498, 12, sf::Color(160, 160, 160));
 
-    renderText("Recent Points:", uiX, 120, 18, sf::Color::Cyan);
-    auto recentScores = scoreManager.getRecentScores();
-    for (size_t i = 0; i < recentScores.size(); i++) {
-        ss.str("");
-        ss << "+" << recentScores[i];
-        renderText(ss.str(), uiX, 145 + i * 20, 16, sf::Color::Green);
+    if (profilerOverlay) {
+        renderProfiler();
     }
+}
 
-    ss.str("");
-    ss << "Food: " << food.getCount();
-    renderText(ss.str(), uiX, 260, 22, sf::Color::Red);
+// Per-phase min/avg/p99 over the profiler window, drawn over the controls help
+void Game::renderProfiler() {
+    float uiX = BOARD_PIXEL_WIDTH + 10;
+    sf::FloatRect area(BOARD_PIXEL_WIDTH + 5, 300, 190, 172);
+    hud.drawPanel(window, PANEL_PROFILER, 0, area, [this, uiX, area](sf::RenderTarget& target) {
+        sf::RectangleShape background(sf::Vector2f(area.width, area.height));
+        background.setPosition(area.left, area.top);
+        background.setFillColor(sf::Color(10, 10, 30, 245));
+        target.draw(background);
+        renderText(target, "Profile us: min/avg/p99", uiX, 304, 13, sf::Color::Yellow);
+    });
+
+    // Summaries cost a partial sort per phase, so refresh a few times a second
+    if (--profileRefreshCountdown <= 0) {
+        profileRefreshCountdown = PROFILE_REFRESH_FRAMES;
+        for (int phase = 0; phase < PHASE_COUNT; phase++) {
+            PhaseSummary summary = profiler.summarize(static_cast<ProfilePhase>(phase));
+            std::snprintf(profileLines[phase], sizeof(profileLines[phase]), "%-12s %.0f/%.0f/%.0f",
+                          Profiler::phaseName(static_cast<ProfilePhase>(phase)),
+                          summary.minMicros, summary.avgMicros, summary.p99Micros);
+        }
+    }
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        hud.drawText(window, HUD_PROFILE + phase, profileLines[phase], uiX, 324 + phase * 13, 11,
+                     profiler.isRecording() ? sf::Color(255, 140, 140) : sf::Color(200, 200, 200));
+    }
+}
 
-    renderText("Controls:", uiX, 310, 18, sf::Color::Yellow);
-    renderText("WASD: Move", uiX, 335, 14);
-    renderText("P: Pause", uiX, 355, 14);
-    renderText("U: Undo Score", uiX, 375, 14);
+void Game::toggleProfileCsv() {
+    if (profiler.isRecording()) {
+        profiler.stopCsv();
+        std::cout << "Stopped writing frame_profile.csv" << std::endl;
+    } else if (profiler.startCsv("frame_profile.csv")) {
+        std::cout << "Recording per-frame phase times to frame_profile.csv" << std::endl;
+    } else {
+        std::cerr << "Failed to open frame_profile.csv" << std::endl;
+    }
 }
 
 void Game::run() {
+    gameClock.restart();
     while (window.isOpen()) {
-        handleEvents();
-        
-        if (state == PLAYING && gameClock.getElapsedTime().asSeconds() > gameSpeed) {
-            update();
-            gameClock.restart();
+        {
+            ProfileScope frameScope(&profiler, PHASE_FRAME);
+            {
+                ProfileScope eventScope(&profiler, PHASE_EVENTS);
+                handleEvents();
+            }
+
+            // Fixed-step simulation: bank real time and run as many whole ticks
+            // as it covers, so the tick rate is exact regardless of frame rate
+            float frameSeconds = std::min(gameClock.restart().asSeconds(), 0.25f);
+            if (state == PLAYING || state == ARENA) {
+                GameState ticking = state;
+                tickAccumulator += frameSeconds;
+                int ticks = 0;
+                while (state == ticking && tickAccumulator >= gameSpeed && ticks < MAX_TICKS_PER_FRAME) {
+                    ProfileScope updateScope(&profiler, PHASE_UPDATE);
+                    if (ticking == ARENA) {
+                        updateArena();
+                    } else {
+                        update();
+                    }
+                    tickAccumulator -= gameSpeed;
+                    ticks++;
+                }
+                if (ticks == MAX_TICKS_PER_FRAME) {
+                    // Too far behind: drop the backlog rather than spiral
+                    tickAccumulator = std::min(tickAccumulator, gameSpeed);
+                }
+                tickAlpha = std::min(tickAccumulator / gameSpeed, 1.0f);
+            }
+
+            render();
         }
-        
-        render();
+        profiler.endFrame();
+        assets.poll();
+        reportStartup();
+    }
+}
+
+void Game::reportStartup() {
+    if (!firstFrameMillis) {
+        firstFrameMillis = startupClock.getElapsedTime().asMicroseconds() / 1000.0f;
+        std::cout << "Time to first frame: " << firstFrameMillis << " ms" << std::endl;
+    }
+    if (!assetsReported && assets.isIdle()) {
+        const AssetLoadStats& loads = assets.getStats();
+        assetsReported = true;
+        std::cout << "Time to fully loaded: " << startupClock.getElapsedTime().asMicroseconds() / 1000.0f << " ms ("
+                  << loads.loaded << " assets, " << loads.failed << " failed, "
+                  << loads.decodeMillis << " ms decoding in the background)" << std::endl;
     }
 }
 
+void Game::queueTurn(Direction dir) {
+    inputQueue.push(dir, inputClock.getElapsedTime().asMicroseconds(), simulation.getSnake().getDirection());
+}
+
+void Game::applyFramePacing() {
+    window.setVerticalSyncEnabled(pacing == PACING_VSYNC);
+    window.setFramerateLimit(pacing == PACING_CAP_60 ? 60 : 0);
+}
+
 void Game::handleEvents() {
     sf::Event event;
     while (window.pollEvent(event)) {
@@ -157,12 +266,24 @@ void Game::handleEvents() {
         }
         
         if (event.type == sf::Event::KeyPressed) {
+            if (event.key.code == sf::Keyboard::F3) {
+                profilerOverlay = !profilerOverlay;
+                profileRefreshCountdown = 0;
+            } else if (event.key.code == sf::Keyboard::F6) {
+                toggleProfileCsv();
+            }
+
             switch (state) {
                 case MENU:
                     if (event.key.code == sf::Keyboard::Space) {
                         startNewGame();
                     } else if (event.key.code == sf::Keyboard::H) {
                         state = HIGH_SCORES;
+                    } else if (event.key.code == sf::Keyboard::M) {
+                        startArena();
+                    } else if (event.key.code == sf::Keyboard::L) {
+                        int next = (simulation.getLevelStyle() + 1) % LEVEL_STYLE_COUNT;
+                        simulation.setLevelStyle(static_cast<LevelStyle>(next));
                     } else if (event.key.code == sf::Keyboard::Escape) {
                         window.close();
                     }
@@ -170,17 +291,25 @@ void Game::handleEvents() {
                     
                 case PLAYING:
                     if (event.key.code == sf::Keyboard::W) {
-                        snake.setDirection(UP);
+                        queueTurn(UP);
                     } else if (event.key.code == sf::Keyboard::S) {
-                        snake.setDirection(DOWN);
+                        queueTurn(DOWN);
                     } else if (event.key.code == sf::Keyboard::A) {
-                        snake.setDirection(LEFT);
+                        queueTurn(LEFT);
                     } else if (event.key.code == sf::Keyboard::D) {
-                        snake.setDirection(RIGHT);
+                        queueTurn(RIGHT);
                     } else if (event.key.code == sf::Keyboard::P) {
                         pauseGame();
-                    } else if (event.key.code == sf::Keyboard::U && scoreManager.canUndo()) {
-                        scoreManager.undoLastScore();
+                    } else if (event.key.code == sf::Keyboard::U && simulation.getScoreManager().canUndo()) {
+                        simulation.getScoreManager().undoLastScore();
+                        recorder.recordUndo(simulation);
+                    } else if (event.key.code == sf::Keyboard::I) {
+                        toggleAIMode();
+                    } else if (event.key.code == sf::Keyboard::F2) {
+                        boardRenderer.setStaticCacheEnabled(!boardRenderer.isStaticCacheEnabled());
+                    } else if (event.key.code == sf::Keyboard::F4) {
+                        pacing = static_cast<FramePacing>((pacing + 1) % 3);
+                        applyFramePacing();
                     }
                     break;
                     
@@ -203,6 +332,21 @@ void Game::handleEvents() {
                         state = MENU;
                     }
                     break;
+
+                case ARENA:
+                    // The latest key steers; the arena ignores reversals
+                    if (event.key.code == sf::Keyboard::W) {
+                        arena->setPlayerDirection(UP);
+                    } else if (event.key.code == sf::Keyboard::S) {
+                        arena->setPlayerDirection(DOWN);
+                    } else if (event.key.code == sf::Keyboard::A) {
+                        arena->setPlayerDirection(LEFT);
+                    } else if (event.key.code == sf::Keyboard::D) {
+                        arena->setPlayerDirection(RIGHT);
+                    } else if (event.key.code == sf::Keyboard::Escape) {
+                        state = MENU;
+                    }
+                    break;
             }
         }
     }
@@ -210,152 +354,161 @@ void Game::handleEvents() {
 
 void Game::update() {
     if (state != PLAYING) return;
-    
-    SnakeSegment head = snake.getHead();
-    std::cout << "Head at: (" << head.x << ", " << head.y << ")\n";
 
-if (!gameGraph.isValidMove(head.x, head.y, head.x, head.y)) {
-    std::cout << "Invalid move at: (" << head.x << ", " << head.y << ")\n";
-}
-if (gameGraph.isWall(head.x, head.y)) {
-    std::cout << "Wall detected at head position!\n";
-}
-  
-    SnakeSegment newHead = head;
-    
-    // Calculate new head position based on direction
-    switch (snake.getHead().x < head.x ? LEFT : 
-            snake.getHead().x > head.x ? RIGHT :
-            snake.getHead().y < head.y ? UP : DOWN) {
-        //  the actual direction is handled in Snake class
+    // One buffered turn per tick
+    TimedInput input;
+    if (inputQueue.pop(input)) {
+        simulation.setDirection(input.direction);
+        keyToTick.add((inputClock.getElapsedTime().asMicroseconds() - input.timestampMicros) / 1000.0);
+        awaitingPresent = true;
+        pendingKeyMicros = input.timestampMicros;
     }
-    
-    snake.move();
-    head = snake.getHead();
-    
-    // Check wall collision using graph
-   if (head.x < 0 || head.x >= GRID_WIDTH || head.y < 0 || head.y >= GRID_HEIGHT || gameGraph.isWall(head.x, head.y)) {
-    scoreManager.gameOver();
-    collisionSound.play();
-    state = GAME_OVER;
-    return;
-}
 
-    
-    // Check boundary collision
-    if (head.x < 0 || head.x >= GRID_WIDTH || head.y < 0 || head.y >= GRID_HEIGHT) {
-        scoreManager.gameOver();
-        collisionSound.play();
-        state = GAME_OVER;
-        return;
+    if (aiMode == AI_GREEDY) {
+        simulation.setDirection(autopilot.decide(simulation));
+    } else if (aiMode == AI_HAMILTONIAN) {
+        simulation.setDirection(hamiltonian.decide(simulation));
+    } else if (aiMode == AI_MCTS) {
+        simulation.setDirection(mcts->decide(simulation, MCTS_BUDGET_MILLIS));
     }
-    
-    // Check self collision
-    if (snake.checkSelfCollision()) {
+
+    StepResult result = simulation.step();
+    recorder.recordTick(simulation);
+    if (!result.alive) {
         collisionSound.play();
-        scoreManager.gameOver();
         state = GAME_OVER;
+        recorder.finish(simulation);
+        if (!recorder.getReplay().save(replayPath)) {
+            std::cerr << "Failed to save replay to " << replayPath << std::endl;
+        }
+        ScoreRecord record;
+        record.time = static_cast<int64_t>(std::time(nullptr));
+        record.seed = simulation.getSeed();
+        record.score = simulation.getScoreManager().getCurrentScore();
+        record.level = simulation.getScoreManager().getCurrentLevel();
+        record.ticks = static_cast<uint32_t>(simulation.getTickCount());
+        if (scoreStore.isOpen() && !scoreStore.append(record)) {
+            std::cerr << "Failed to save score" << std::endl;
+        }
         return;
     }
-    
-    // Check food collision
-    if (food.checkCollision(head.x, head.y)) {
+
+    if (result.ateFood) {
         eatSound.play();
-        snake.grow();
-        scoreManager.addScore(10);
-        
-        // Check for level up
-        if (scoreManager.getCurrentScore() % 100 == 0) {
-            levelUpSound.play();
-            nextLevel();
-        }
-        
-        // Spawn new food
-        std::vector<sf::Vector2i> occupiedPositions;
-        for (const auto& segment : snake.getBody()) {
-            occupiedPositions.push_back(sf::Vector2i(segment.x, segment.y));
+        if (result.boardFull) {
+            std::cout << "Board full: no free cell left for food" << std::endl;
         }
-        food.spawnRandom(GRID_WIDTH, GRID_HEIGHT, occupiedPositions);
     }
-    
-    // Maintain food count
-    if (food.getCount() < 3) {
-        std::vector<sf::Vector2i> occupiedPositions;
-        for (const auto& segment : snake.getBody()) {
-            occupiedPositions.push_back(sf::Vector2i(segment.x, segment.y));
+    if (result.leveledUp) {
+        levelUpSound.play();
+        nextLevel();
+        if (aiMode == AI_HAMILTONIAN) {
+            hamiltonian.prepare(simulation);
         }
-        food.spawnRandom(GRID_WIDTH, GRID_HEIGHT, occupiedPositions);
     }
 }
 
 void Game::render() {
-    window.clear(sf::Color::Black);
-    
-    switch (state) {
-        case MENU:
-            renderMenu();
-            break;
-        case PLAYING:
-        case PAUSED:
-            renderGame();
-            break;
-        case GAME_OVER:
-            renderGameOver();
-            break;
-        case HIGH_SCORES:
-            renderHighScores();
-            break;
+    {
+        ProfileScope renderScope(&profiler, PHASE_RENDER);
+        frameClock.restart();
+        window.clear(sf::Color::Black);
+        // Numbers that change every frame would re-layout their text every frame
+        statsDue = state != statsState || statsClock.getElapsedTime().asMilliseconds() >= STATS_REFRESH_MILLIS;
+        if (statsDue) statsClock.restart();
+        statsState = state;
+
+        switch (state) {
+            case MENU:
+                renderMenu();
+                break;
+            case PLAYING:
+            case PAUSED:
+                renderGame();
+                break;
+            case GAME_OVER:
+                renderGameOver();
+                break;
+            case HIGH_SCORES:
+                renderHighScores();
+                break;
+            case ARENA:
+                renderArena();
+                break;
+        }
+
+        float millis = frameClock.getElapsedTime().asMicroseconds() / 1000.0f;
+        frameMillis = frameMillis * 0.95f + millis * 0.05f;
+    }
+    {
+        ProfileScope presentScope(&profiler, PHASE_PRESENT);
+        window.display();
+    }
+
+    if (awaitingPresent) {
+        keyToFrame.add((inputClock.getElapsedTime().asMicroseconds() - pendingKeyMicros) / 1000.0);
+        awaitingPresent = false;
     }
-    
-    window.display();
 }
 
 void Game::renderMenu() {
-    renderText("SNAKE GAME", WINDOW_WIDTH / 2 - 150, 150, 48, sf::Color::Green);
-    renderText("Press SPACE to Start", WINDOW_WIDTH / 2 - 120, 250);
-    renderText("Press H for High Scores", WINDOW_WIDTH / 2 - 130, 300);
-    renderText("Press ESC to Exit", WINDOW_WIDTH / 2 - 100, 350);
-    renderText("Controls: WASD keys, P (Pause), U (Undo)", WINDOW_WIDTH / 2 - 200, 450, 18);
+    LevelStyle style = simulation.getLevelStyle();
+    hud.drawPanel(window, PANEL_MENU, style, sf::FloatRect(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT), [this, style](sf::RenderTarget& target) {
+        renderText(target, "SNAKE GAME", WINDOW_WIDTH / 2 - 150, 150, 48, sf::Color::Green);
+        renderText(target, "Press SPACE to Start", WINDOW_WIDTH / 2 - 120, 250);
+        renderText(target, "Press H for High Scores", WINDOW_WIDTH / 2 - 130, 300);
+        renderText(target, "Press M for the Arena", WINDOW_WIDTH / 2 - 125, 340);
+        renderText(target, "Press ESC to Exit", WINDOW_WIDTH / 2 - 100, 380);
+        renderText(target, std::string("Press L for Levels: ") + LevelGenerator::styleName(style), WINDOW_WIDTH / 2 - 130, 420);
+        renderText(target, "Controls: WASD keys, P (Pause), U (Undo), I (AI mode)", WINDOW_WIDTH / 2 - 250, 470, 18);
+    });
 }
 
-void Game::renderGame() {
-    sf::RectangleShape bg;
-    bg.setSize(sf::Vector2f(GRID_WIDTH * CELL_SIZE, GRID_HEIGHT * CELL_SIZE));
-    bg.setFillColor(sf::Color(10, 10, 10));
-    window.draw(bg);
-
-    sf::RectangleShape gridLine(sf::Vector2f(1, GRID_HEIGHT * CELL_SIZE));
-    gridLine.setFillColor(sf::Color(35, 35, 35));
-    for (int x = 0; x <= GRID_WIDTH; x++) {
-        gridLine.setPosition(x * CELL_SIZE, 0);
-        window.draw(gridLine);
-    }
+// Centres the board view on the interpolated head, clamped to the board
+// edges, and returns the visible area in world pixels
+sf::FloatRect Game::updateCamera() {
+    SnakeBodyView body = simulation.getSnake().getBody();
+    SnakeSegment to = body[0];
+    SnakeSegment from = body.size() > 1 ? body[1] : to;
+    float headX = (from.x + (to.x - from.x) * tickAlpha + 0.5f) * CELL_SIZE;
+    float headY = (from.y + (to.y - from.y) * tickAlpha + 0.5f) * CELL_SIZE;
+    return placeCamera(headX, headY, gridWidth, gridHeight);
+}
 
-    gridLine.setSize(sf::Vector2f(GRID_WIDTH * CELL_SIZE, 1));
-    for (int y = 0; y <= GRID_HEIGHT; y++) {
-        gridLine.setPosition(0, y * CELL_SIZE);
-        window.draw(gridLine);
-    }
+sf::FloatRect Game::placeCamera(float headX, float headY, int columns, int rows) {
+    // The board viewport covers the top-left of the window (less on small boards)
+    float viewWidth = static_cast<float>(std::min(columns, static_cast<int>(VIEW_COLUMNS)) * CELL_SIZE);
+    float viewHeight = static_cast<float>(std::min(rows, static_cast<int>(VIEW_ROWS)) * CELL_SIZE);
+    boardView.setSize(viewWidth, viewHeight);
+    boardView.setViewport(sf::FloatRect(0, 0, viewWidth / WINDOW_WIDTH, viewHeight / WINDOW_HEIGHT));
+
+    sf::Vector2f size = boardView.getSize();
+    float worldWidth = static_cast<float>(columns * CELL_SIZE);
+    float worldHeight = static_cast<float>(rows * CELL_SIZE);
+    float centerX = std::min(std::max(headX, size.x / 2), worldWidth - size.x / 2);
+    float centerY = std::min(std::max(headY, size.y / 2), worldHeight - size.y / 2);
+    boardView.setCenter(centerX, centerY);
+    return sf::FloatRect(centerX - size.x / 2, centerY - size.y / 2, size.x, size.y);
+}
 
-    sf::RectangleShape wall(sf::Vector2f(CELL_SIZE, CELL_SIZE));
-    wall.setFillColor(sf::Color(80, 80, 80));
-    for (int x = 0; x < GRID_WIDTH; x++) {
-        for (int y = 0; y < GRID_HEIGHT; y++) {
-            if (gameGraph.isWall(x, y)) {
-                wall.setPosition(x * CELL_SIZE, y * CELL_SIZE);
-                window.draw(wall);
-            }
-        }
+void Game::renderGame() {
+    sf::FloatRect visible = updateCamera();
+    boardRenderer.update(simulation, tickAlpha, visible);
+    window.setView(boardView);
+    boardRenderer.draw(window);
+    window.setView(window.getDefaultView());
+
+    {
+        ProfileScope hudScope(&profiler, PHASE_HUD);
+        renderUI();
     }
 
-    snake.render(window, CELL_SIZE);
-    food.render(window, CELL_SIZE);
-
-    renderUI();
-
     if (state == PAUSED) {
-        renderText("PAUSED", WINDOW_WIDTH / 2 - 80, WINDOW_HEIGHT / 2 - 50, 36, sf::Color::Yellow);
-        renderText("Press P to Resume", WINDOW_WIDTH / 2 - 100, WINDOW_HEIGHT / 2);
+        sf::FloatRect overlay(0, WINDOW_HEIGHT / 2 - 60, WINDOW_WIDTH, 110);
+        hud.drawPanel(window, PANEL_PAUSED, 0, overlay, [this](sf::RenderTarget& target) {
+            renderText(target, "PAUSED", WINDOW_WIDTH / 2 - 80, WINDOW_HEIGHT / 2 - 50, 36, sf::Color::Yellow);
+            renderText(target, "Press P to Resume", WINDOW_WIDTH / 2 - 100, WINDOW_HEIGHT / 2);
+        });
     }
 }
 
@@ -401,35 +554,42 @@ void Game::renderGame() {
 }*/
 
 void Game::renderGameOver() {
-    renderText("GAME OVER", WINDOW_WIDTH / 2 - 120, 200, 36, sf::Color::Red);
-    
-    std::stringstream ss;
-    ss << "Final Score: " << scoreManager.getCurrentScore();
-    renderText(ss.str(), WINDOW_WIDTH / 2 - 100, 270);
-    
-    ss.str("");
-    ss << "Level Reached: " << scoreManager.getCurrentLevel();
-    renderText(ss.str(), WINDOW_WIDTH / 2 - 100, 320);
-    renderText("Press SPACE for Menu", WINDOW_WIDTH / 2 - 120, 370);
-    renderText("Press R to Restart", WINDOW_WIDTH / 2 - 100, 420);
+    hud.drawPanel(window, PANEL_GAME_OVER, 0, sf::FloatRect(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT), [this](sf::RenderTarget& target) {
+        renderText(target, "GAME OVER", WINDOW_WIDTH / 2 - 120, 200, 36, sf::Color::Red);
+        renderText(target, "Press SPACE for Menu", WINDOW_WIDTH / 2 - 120, 370);
+        renderText(target, "Press R to Restart", WINDOW_WIDTH / 2 - 100, 420);
+    });
+
+    const ScoreManager& scores = simulation.getScoreManager();
+    hud.drawValue(window, HUD_FINAL_SCORE, "Final Score: ", scores.getCurrentScore(), WINDOW_WIDTH / 2 - 100, 270, 24);
+    hud.drawValue(window, HUD_LEVEL_REACHED, "Level Reached: ", scores.getCurrentLevel(), WINDOW_WIDTH / 2 - 100, 320, 24);
 }
 
 void Game::renderHighScores() {
-    renderText("HIGH SCORES", WINDOW_WIDTH / 2 - 120, 100, 36, sf::Color::Yellow);
-    
-    auto highScores = scoreManager.getHighScores();
-    for (size_t i = 0; i < highScores.size() && i < 10; i++) {
-        std::stringstream ss;
-        ss << (i + 1) << ". Score: " << highScores[i].score 
-           << " Level: " << highScores[i].level;
-        renderText(ss.str(), 50, 150 + i * 30, 20);
-    }
-    
-    if (highScores.empty()) {
-        renderText("No high scores yet!", WINDOW_WIDTH / 2 - 100, 200);
-    }
-    
-    renderText("Press ESC to return to menu", WINDOW_WIDTH / 2 - 150, WINDOW_HEIGHT - 50);
+    // Re-rendered only when a finished game changed the table; the rows
+    // come straight from the store's top-K index
+    hud.drawPanel(window, PANEL_HIGH_SCORES, scoreStore.getRevision(),
+                  sf::FloatRect(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT), [this](sf::RenderTarget& target) {
+        renderText(target, "HIGH SCORES", WINDOW_WIDTH / 2 - 120, 100, 36, sf::Color::Yellow);
+
+        const std::vector<ScoreRecord>& highScores = scoreStore.getTop();
+        for (size_t i = 0; i < highScores.size() && i < 10; i++) {
+            std::stringstream ss;
+            ss << (i + 1) << ". Score: " << highScores[i].score
+               << " Level: " << highScores[i].level
+               << "   " << ScoreManager::formatTimestamp(highScores[i].time);
+            renderText(target, ss.str(), 50, 150 + i * 30, 20);
+        }
+        std::stringstream total;
+        total << scoreStore.getGameCount() << " games played";
+        renderText(target, total.str(), 50, 460, 16, sf::Color(180, 180, 180));
+        
+        if (highScores.empty()) {
+            renderText(target, "No high scores yet!", WINDOW_WIDTH / 2 - 100, 200);
+        }
+        
+        renderText(target, "Press ESC to return to menu", WINDOW_WIDTH / 2 - 150, WINDOW_HEIGHT - 50);
+    });
 }
 /*
 void Game::renderUI() {
@@ -472,37 +632,125 @@ void Game::renderUI() {
 }
 */
 void Game::startNewGame() {
-    scoreManager.reset();
-    gameGraph.generateWallLevel(1);
-    
-    int startX = 5;
-    int startY = 5;
-    while (gameGraph.isWall(startX, startY)) {
-        startX++;
-        if (startX >= GRID_WIDTH) {
-            startX = 0;
-            startY++;
-            if (startY >= GRID_HEIGHT) startY = 0;
-        }
+    // Games started under the cycle AI get layouts its cycle can always cover
+    simulation.setCycleLayouts(aiMode == AI_HAMILTONIAN);
+    simulation.reset();
+    recorder.begin(simulation);
+    if (aiMode == AI_HAMILTONIAN) {
+        hamiltonian.prepare(simulation);
     }
-    snake.reset(startX, startY);
-    std::cout << "Starting at (" << startX << ", " << startY << ")" << std::endl;
-
-    food.clear();
-    food.loadTexture("../assets/images/apple.png"); 
+    SnakeSegment head = simulation.getSnake().getHead();
+    std::cout << "Starting at (" << head.x << ", " << head.y << "), seed " << simulation.getSeed() << std::endl;
 
-    
-    std::vector<sf::Vector2i> occupiedPositions;
-    for (const auto& segment : snake.getBody()) {
-        occupiedPositions.push_back(sf::Vector2i(segment.x, segment.y));
-    }
-    food.spawnRandom(GRID_WIDTH, GRID_HEIGHT, occupiedPositions);
-    
     state = PLAYING;
     gameRunning = true;
-    gameClock.restart();
+    inputQueue.clear();
+    tickAccumulator = 0;
+    tickAlpha = 0;
+}
+
+
+void Game::startArena() {
+    if (!arena) {
+        ArenaConfig config;
+        config.width = config.height = ARENA_SIZE;
+        config.snakes = ARENA_SNAKES;
+        arena.reset(new Arena(config));
+        arena->setPlayerSnake(0);
+    }
+    // The style may have been changed from the menu since the last visit
+    arena->setLevelStyle(simulation.getLevelStyle());
+    arena->reset(static_cast<uint64_t>(std::time(nullptr)));
+    const ArenaSnake& player = arena->getSnakes()[0];
+    std::cout << "Arena: " << ARENA_SNAKES << " snakes on " << ARENA_SIZE << "x" << ARENA_SIZE << ", starting at ("
+              << arena->cellX(player.head) << ", " << arena->cellY(player.head) << ")" << std::endl;
+
+    arena->setPlayerDirection(player.direction);
+    // Centre of the board until the player's head is known
+    arenaCameraX = ARENA_SIZE * CELL_SIZE * 0.5f;
+    arenaCameraY = ARENA_SIZE * CELL_SIZE * 0.5f;
+    state = ARENA;
+    tickAccumulator = 0;
+}
+
+void Game::updateArena() {
+    // The player's snake respawns like the others, so the arena never ends
+    const ArenaSnake& player = arena->getSnakes()[arena->getPlayerSnake()];
+    bool wasAlive = player.alive;
+    int scoreBefore = player.score;
+    arena->step();
+    if (wasAlive && !player.alive) {
+        collisionSound.play();
+    } else if (player.score > scoreBefore) {
+        eatSound.play();
+    }
+}
+
+void Game::renderArena() {
+    const ArenaSnake& player = arena->getSnakes()[arena->getPlayerSnake()];
+    if (player.alive && player.head >= 0) {
+        arenaCameraX = (arena->cellX(player.head) + 0.5f) * CELL_SIZE;
+        arenaCameraY = (arena->cellY(player.head) + 0.5f) * CELL_SIZE;
+    }
+    sf::FloatRect visible = placeCamera(arenaCameraX, arenaCameraY, arena->getWidth(), arena->getHeight());
+    boardRenderer.updateArena(*arena, visible);
+    window.setView(boardView);
+    boardRenderer.draw(window);
+    window.setView(window.getDefaultView());
+
+    ProfileScope hudScope(&profiler, PHASE_HUD);
+    float uiX = BOARD_PIXEL_WIDTH + 10;
+    sf::FloatRect sidebar(BOARD_PIXEL_WIDTH, 0, WINDOW_WIDTH - BOARD_PIXEL_WIDTH, WINDOW_HEIGHT);
+    hud.drawPanel(window, PANEL_ARENA, 0, sidebar, [this, uiX](sf::RenderTarget& target) {
+        sf::RectangleShape uiPanel;
+        uiPanel.setSize(sf::Vector2f(190, WINDOW_HEIGHT - 20));
+        uiPanel.setPosition(BOARD_PIXEL_WIDTH + 5, 10);
+        uiPanel.setFillColor(sf::Color(25, 25, 25, 230));
+        uiPanel.setOutlineColor(sf::Color::White);
+        uiPanel.setOutlineThickness(2);
+        target.draw(uiPanel);
+
+        renderText(target, "ARENA", uiX, 120, 18, sf::Color::Cyan);
+        renderText(target, "Controls:", uiX, 310, 18, sf::Color::Yellow);
+        renderText(target, "WASD: Steer (green)", uiX, 335, 14);
+        renderText(target, "ESC: Menu", uiX, 355, 14);
+    });
+
+    hud.drawValue(window, HUD_SCORE, "Score: ", player.score, uiX, 20, 22, sf::Color::White);
+    hud.drawValue(window, HUD_LENGTH, "Length: ", player.alive ? player.length : 0, uiX, 80, 22, sf::Color::White);
+
+    if (statsDue) {
+        const ArenaStats& stats = arena->getStats();
+        std::snprintf(arenaLine, sizeof(arenaLine), "%d/%d alive, tick %.0f us", stats.alive, ARENA_SNAKES,
+                      stats.lastTickMicros);
+        std::snprintf(arenaFrameLine, sizeof(arenaFrameLine), "Frame %.2f ms, %d segments drawn", frameMillis,
+                      boardRenderer.getStats().drawnSegments);
+    }
+    hud.drawText(window, HUD_ARENA, arenaLine, uiX, 150, 14, sf::Color::Green);
+    if (!player.alive) {
+        hud.drawValue(window, HUD_RESPAWN, "Respawn in ", player.respawnIn, uiX, 180, 18, sf::Color::Red);
+    }
+
+    hud.drawText(window, HUD_FRAME, arenaFrameLine, uiX, 480, 12, sf::Color(160, 160, 160));
 }
 
+void Game::toggleAIMode() {
+    // Off -> greedy BFS -> Hamiltonian cycle -> tree search -> off
+    aiMode = static_cast<AIMode>((aiMode + 1) % 4);
+    autopilot.resetStats();
+    if (aiMode == AI_HAMILTONIAN) {
+        if (!hamiltonian.prepare(simulation)) {
+            std::cout << "No cycle covers this layout; steering greedily (start a new game in this mode to fill the board)" << std::endl;
+        }
+    } else if (aiMode == AI_MCTS) {
+        // The planner's threads only exist once the mode is used
+        if (!mcts) mcts.reset(new MctsPlanner(gridWidth, gridHeight, simulation.getFood().getMaxCount()));
+        mcts->resetStats();
+    }
+
+    static const char* modeNames[] = { "off", "greedy", "hamiltonian", "mcts" };
+    std::cout << "Autopilot " << modeNames[aiMode] << std::endl;
+}
 
 void Game::pauseGame() {
     state = PAUSED;
@@ -510,26 +758,12 @@ void Game::pauseGame() {
 
 void Game::resumeGame() {
     state = PLAYING;
-    gameClock.restart();
 }
 
 void Game::nextLevel() {
-    int newLevel = scoreManager.getCurrentLevel() + 1;
-    scoreManager.setLevel(newLevel);
-    
-    // Increase game speed
+    // Level state (walls, food) is advanced by the simulation; the client
+    // only speeds up its tick rate
     gameSpeed = std::max(0.05f, gameSpeed - 0.01f);
-    
-    // Generate new wall layout
-    gameGraph.generateWallLevel(newLevel);
-    
-    // Clear and respawn food
-    food.clear();
-    std::vector<sf::Vector2i> occupiedPositions;
-    for (const auto& segment : snake.getBody()) {
-        occupiedPositions.push_back(sf::Vector2i(segment.x, segment.y));
-    }
-    food.spawnRandom(GRID_WIDTH, GRID_HEIGHT, occupiedPositions);
 }
 /*S
 void Game::renderText(const std::string& text, float x, float y, int size, sf::Color color) {
@@ -3,41 +3,107 @@
 
 #include <SFML/Audio.hpp>
 #include <SFML/Graphics.hpp>
-#include "Snake.h"
-#include "Food.h"
-#include "ScoreManager.h"
-#include "Graph.h"
+#include "Simulation.h"
+#include "Autopilot.h"
+#include "HamiltonianSolver.h"
+#include "MctsPlanner.h"
+#include "Arena.h"
+#include "BoardRenderer.h"
+#include "HudCache.h"
+#include "InputQueue.h"
+#include "Profiler.h"
+#include "Replay.h"
+#include "AssetManager.h"
+#include "ScoreStore.h"
 
 
-enum GameState { MENU, PLAYING, GAME_OVER, PAUSED, HIGH_SCORES };
+enum GameState { MENU, PLAYING, GAME_OVER, PAUSED, HIGH_SCORES, ARENA };
+enum AIMode { AI_OFF, AI_GREEDY, AI_HAMILTONIAN, AI_MCTS };
+enum FramePacing { PACING_VSYNC, PACING_UNCAPPED, PACING_CAP_60 };
+
+// Cached HUD text slots (HUD_PROFILE + phase for profiler rows, HUD_RECENT + i
+// for the i-th recent score) and pre-rendered static panels
+enum HudSlot { HUD_SCORE, HUD_LEVEL, HUD_LENGTH, HUD_FOOD, HUD_AI, HUD_FRAME, HUD_INPUT, HUD_FINAL_SCORE, HUD_LEVEL_REACHED,
+               HUD_ARENA, HUD_RESPAWN, HUD_PROFILE, HUD_RECENT = HUD_PROFILE + PHASE_COUNT };
+enum HudPanel { PANEL_MENU, PANEL_SIDEBAR, PANEL_PAUSED, PANEL_GAME_OVER, PANEL_HIGH_SCORES, PANEL_PROFILER, PANEL_ARENA };
 
 class Game {
 private:
+    sf::Clock startupClock;     // Started before the window opens
     sf::RenderWindow window;
-    Snake snake;
-    Food food;
-    ScoreManager scoreManager;
-    Graph gameGraph;
+    Simulation simulation;
+    Autopilot autopilot;
+    HamiltonianSolver hamiltonian;
+    std::unique_ptr<MctsPlanner> mcts;  // Created on first use, with a thread per core
+    std::unique_ptr<Arena> arena;       // Created the first time the arena is entered
+    float arenaCameraX, arenaCameraY;   // Player's last live head, held while it waits to respawn
+    BoardRenderer boardRenderer;
     GameState state;
     sf::Font font;
+    HudCache hud;
     sf::Clock gameClock;
     sf::Time lastUpdate;
-    sf::Music bgMusic;
-    sf::SoundBuffer eatBuffer, collisionBuffer, levelBuffer;
+    AssetManager assets;        // Owns the sound buffers, textures and music
     sf::Sound eatSound, collisionSound, levelUpSound;
+    float firstFrameMillis;
+    bool assetsReported;
 
-    static const int GRID_WIDTH = 30;
-    static const int GRID_HEIGHT = 20;
+    // The board can be any size; the window shows at most VIEW_COLUMNS x
+    // VIEW_ROWS cells of it through a camera that follows the head
+    int gridWidth, gridHeight;
     static const int CELL_SIZE = 25;
-    static const int WINDOW_WIDTH = GRID_WIDTH * CELL_SIZE + 200; // Extra space for UI
-    static const int WINDOW_HEIGHT = GRID_HEIGHT * CELL_SIZE + 100;
+    static const int VIEW_COLUMNS = 30;
+    static const int VIEW_ROWS = 20;
+    static const int BOARD_PIXEL_WIDTH = VIEW_COLUMNS * CELL_SIZE;
+    static const int WINDOW_WIDTH = BOARD_PIXEL_WIDTH + 200; // Extra space for UI
+    static const int WINDOW_HEIGHT = VIEW_ROWS * CELL_SIZE + 100;
+    sf::View boardView;
+    static const int MAX_TICKS_PER_FRAME = 5;   // Catch-up limit after a long frame
+    static const int PROFILE_REFRESH_FRAMES = 15;   // Overlay re-summarizes this often
+    static const int STATS_REFRESH_MILLIS = 250;    // Frame/input/arena lines are re-formatted this often
+    static constexpr double MCTS_BUDGET_MILLIS = 8.0;   // Search time per tick, under one frame
+    static const int ARENA_SIZE = 256;          // Arena board is ARENA_SIZE x ARENA_SIZE cells
+    static const int ARENA_SNAKES = 300;        // The player's snake and AI rivals
     
-    float gameSpeed;
+    sf::Clock frameClock;
+    sf::Clock inputClock;       // Timestamps key events (microseconds since start)
+    InputQueue inputQueue;
+    ReplayRecorder recorder;    // Every game is saved to replayPath when it ends
+    std::string replayPath;     // last_game.snkr in the data directory
+    ScoreStore scoreStore;      // All finished games, kept across runs
+    LatencyStats keyToTick;     // Key arrival -> tick that applied the turn
+    LatencyStats keyToFrame;    // Key arrival -> first frame presented after that tick
+    bool awaitingPresent;
+    unsigned long long pendingKeyMicros;
+    float frameMillis;          // Smoothed CPU time of render(), excluding display()
+    sf::Clock statsClock;
+    GameState statsState;       // Screen the lines below were last formatted for
+    bool statsDue;              // This frame re-formats them
+    char frameLine[64];
+    char inputLine[64];
+    char arenaLine[64];
+    char arenaFrameLine[64];
+    float gameSpeed;            // Seconds per simulation tick
+    float tickAccumulator;      // Unsimulated time carried between frames
+    float tickAlpha;            // Render position between the last two ticks
+    FramePacing pacing;
+    Profiler profiler;
+    bool profilerOverlay;
+    int profileRefreshCountdown;
+    char profileLines[PHASE_COUNT][48];
     bool gameRunning;
+    AIMode aiMode;
    
 
 public:
-    Game();
+    static const int DEFAULT_GRID_WIDTH = 30;
+    static const int DEFAULT_GRID_HEIGHT = 20;
+    static const int MAX_GRID_SIZE = 4096;
+
+    // dataDirectory holds assets.pak (normally the executable's directory);
+    // without one, loose files are read from dataDirectory/../assets
+    Game(int gridWidth = DEFAULT_GRID_WIDTH, int gridHeight = DEFAULT_GRID_HEIGHT,
+         const std::string& dataDirectory = ".");
     void run();
     void toggleAIMode(); 
 private:
@@ -49,12 +115,21 @@ private:
     void renderGameOver();
     void renderHighScores();
     void renderUI();
+    sf::FloatRect updateCamera();
+    sf::FloatRect placeCamera(float headX, float headY, int columns, int rows);
+    void startArena();
+    void updateArena();
+    void renderArena();
+    void renderProfiler();
+    void toggleProfileCsv();
+    void reportStartup();
     void startNewGame();
     void pauseGame();
     void resumeGame();
     void nextLevel();
-    bool loadFont();
-    void renderText(const std::string& text, float x, float y, int size = 24, 
+    void applyFramePacing();
+    void queueTurn(Direction dir);
+    void renderText(sf::RenderTarget& target, const std::string& text, float x, float y, int size = 24, 
                    sf::Color color = sf::Color::White);
 };
 
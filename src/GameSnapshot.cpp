@@ -0,0 +1,135 @@
+#include "GameSnapshot.h"
+#include <algorithm>
+
+GameSnapshot::GameSnapshot(int width, int height, int maxFood) :
+    width(width),
+    height(height),
+    ringMask(0),
+    headIndex(0),
+    length(0),
+    body((static_cast<size_t>(width) * height + 63) / 64, 0),
+    walls(nullptr),
+    food(maxFood, -1),
+    direction(RIGHT),
+    growing(false),
+    alive(false),
+    score(0),
+    ticks(0) {
+    // Room for a snake covering the board, so step() never reallocates
+    int capacity = 4;
+    while (capacity < width * height + 1) capacity <<= 1;
+    ring.resize(capacity);
+    ringMask = capacity - 1;
+}
+
+void GameSnapshot::capture(const Simulation& sim, const uint64_t* wallBits, uint64_t seed) {
+    const Snake& snake = sim.getSnake();
+    walls = wallBits;
+    std::fill(body.begin(), body.end(), 0);
+
+    // Tail first, so the head ends up at headIndex
+    SnakeBodyView segments = snake.getBody();
+    length = 0;
+    for (int i = segments.size() - 1; i >= 0; i--) {
+        const SnakeSegment& segment = segments[i];
+        int cell = segment.y * width + segment.x;
+        ring[length++] = cell;
+        if (segment.x >= 0 && segment.x < width && segment.y >= 0 && segment.y < height) {
+            body[cell >> 6] |= uint64_t(1) << (cell & 63);
+        }
+    }
+    headIndex = length - 1;
+
+    std::fill(food.begin(), food.end(), -1);
+    const std::vector<Position>& positions = sim.getFood().getPositions();
+    for (size_t i = 0; i < positions.size() && i < food.size(); i++) {
+        food[i] = positions[i].y * width + positions[i].x;
+    }
+
+    direction = snake.getDirection();
+    growing = snake.isGrowing();
+    alive = sim.isAlive();
+    score = sim.getScoreManager().getCurrentScore();
+    ticks = 0;
+    rng.seed(seed);
+}
+
+void GameSnapshot::copyFrom(const GameSnapshot& other) {
+    // Only the live part of the ring, unwrapped so the head is last
+    for (int i = 0; i < other.length; i++) {
+        ring[i] = other.ring[(other.headIndex - other.length + 1 + i) & other.ringMask];
+    }
+    headIndex = other.length - 1;
+    length = other.length;
+    std::copy(other.body.begin(), other.body.end(), body.begin());
+    walls = other.walls;
+    std::copy(other.food.begin(), other.food.end(), food.begin());
+    direction = other.direction;
+    growing = other.growing;
+    alive = other.alive;
+    score = other.score;
+    ticks = other.ticks;
+    rng = other.rng;
+}
+
+int GameSnapshot::target(Direction dir) const {
+    int head = ring[headIndex];
+    int x = head % width + (dir == RIGHT) - (dir == LEFT);
+    int y = head / width + (dir == DOWN) - (dir == UP);
+    if (x < 0 || x >= width || y < 0 || y >= height) return -1;
+    return y * width + x;
+}
+
+bool GameSnapshot::isSafe(Direction dir) const {
+    int cell = target(dir);
+    if (cell < 0 || testBit(walls, cell)) return false;
+    // The tail moves away first unless the snake is growing
+    int tail = ring[(headIndex - length + 1) & ringMask];
+    return !testBit(body.data(), cell) || (cell == tail && !growing);
+}
+
+bool GameSnapshot::step(Direction dir) {
+    if (!alive) return false;
+    // Direction values pair up as UP/DOWN and LEFT/RIGHT
+    if ((dir ^ 1) != direction) direction = dir;
+    ticks++;
+
+    int cell = target(direction);
+    if (!isSafe(direction)) {
+        alive = false;
+        return false;
+    }
+    if (!growing) {
+        int tail = ring[(headIndex - length + 1) & ringMask];
+        body[tail >> 6] &= ~(uint64_t(1) << (tail & 63));
+        length--;
+    }
+    growing = false;
+    headIndex = (headIndex + 1) & ringMask;
+    ring[headIndex] = cell;
+    body[cell >> 6] |= uint64_t(1) << (cell & 63);
+    length++;
+
+    for (size_t slot = 0; slot < food.size(); slot++) {
+        if (food[slot] == cell) {
+            food[slot] = -1;
+            growing = true;
+            score += POINTS_PER_FOOD;
+            spawnFood(static_cast<int>(slot));
+            return true;
+        }
+    }
+    return false;
+}
+
+void GameSnapshot::spawnFood(int slot) {
+    // A few random probes; on a nearly full board the slot just stays empty
+    int cells = width * height;
+    for (int attempt = 0; attempt < SPAWN_TRIES; attempt++) {
+        int cell = rng.nextBelow(cells);
+        if (testBit(walls, cell) || testBit(body.data(), cell)) continue;
+        if (std::find(food.begin(), food.end(), cell) != food.end()) continue;
+        food[slot] = cell;
+        return;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef GAMESNAPSHOT_H
+#define GAMESNAPSHOT_H
+
+#include <vector>
+#include <cstdint>
+#include "Simulation.h"
+#include "Random.h"
+
+// Compact copy of a game for look-ahead search: body cells in a ring plus an
+// occupancy bitset, food cells, score and a private RNG. Walls are not
+// copied; every snapshot points at one read-only wall bitset owned by the
+// caller. Cloning with copyFrom() costs O(length + cells / 64) and, once the
+// buffers have grown, never allocates, so a search can clone per rollout.
+//
+// step() follows the Simulation rules for movement, collisions, growth and
+// scoring. What the player cannot know is sampled instead: eaten food
+// respawns at a random free cell from the snapshot's RNG, and walls stay as
+// they are when the score reaches a new level.
+class GameSnapshot {
+private:
+    int width, height;
+    std::vector<int32_t> ring;      // Body cells, head at headIndex
+    int ringMask;
+    int headIndex;
+    int length;
+    std::vector<uint64_t> body;     // One bit per cell
+    const uint64_t* walls;
+    std::vector<int32_t> food;      // Food cells, -1 for an empty slot
+    Direction direction;
+    bool growing;
+    bool alive;
+    int score;
+    unsigned ticks;
+    Random rng;
+
+    static const int POINTS_PER_FOOD = 10;
+    static const int SPAWN_TRIES = 32;
+
+    bool testBit(const uint64_t* bits, int cell) const { return (bits[cell >> 6] >> (cell & 63)) & 1; }
+    void spawnFood(int slot);
+
+public:
+    GameSnapshot(int width, int height, int maxFood);
+    // wallBits holds one bit per cell (y * width + x) and must outlive the
+    // snapshot and its copies; seed drives the sampled food
+    void capture(const Simulation& sim, const uint64_t* wallBits, uint64_t seed);
+    void copyFrom(const GameSnapshot& other);
+    void reseed(uint64_t seed) { rng.seed(seed); }
+
+    // One tick; a reversal keeps the current heading as in Snake. Returns
+    // true if the snake ate.
+    bool step(Direction dir);
+    // Whether moving in dir survives the next tick
+    bool isSafe(Direction dir) const;
+    // Cell the head reaches moving in dir, or -1 off the board
+    int target(Direction dir) const;
+
+    bool isAlive() const { return alive; }
+    int getScore() const { return score; }
+    int getLength() const { return length; }
+    int getHead() const { return ring[headIndex]; }
+    Direction getDirection() const { return direction; }
+    unsigned getTicks() const { return ticks; }
+    int getWidth() const { return width; }
+    const std::vector<int32_t>& getFood() const { return food; }
+};
+
+#endif
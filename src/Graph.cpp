@@ -1,130 +1,105 @@
 #include "Graph.h"
 #include <random>
 #include <algorithm>
+#include <cstdlib>
 
-Graph::Graph(int w, int h) : width(w), height(h) {
-    // Initialize graph 
-    for (int x = 0; x < width; x++) {
-        for (int y = 0; y < height; y++) {
-            int current = getIndex(x, y);
-            adjacencyList[current] = std::unordered_set<int>();
-            
-            // Add connections to adjacent cells
-            if (x > 0) adjacencyList[current].insert(getIndex(x-1, y));
-            if (x < width-1) adjacencyList[current].insert(getIndex(x+1, y));
-            if (y > 0) adjacencyList[current].insert(getIndex(x, y-1));
-            if (y < height-1) adjacencyList[current].insert(getIndex(x, y+1));
-        }
-    }
+Graph::Graph(int w, int h) : width(w), height(h), layoutHash(0), revision(0),
+    rng(std::random_device{}()) {
+    wallBits.assign((static_cast<size_t>(width) * height + 63) / 64, 0);
 }
 
 int Graph::getIndex(int x, int y) const {
     return y * width + x;
 }
 
+uint64_t Graph::cellKey(int index) {
+    // splitmix64 finalizer, so toggling a cell flips an unrelated-looking key
+    uint64_t z = static_cast<uint64_t>(index) + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
 std::pair<int, int> Graph::getCoordinates(int index) const {
     return {index % width, index / width};
 }
 
 void Graph::addWall(int x, int y) {
-    if (x < 0 || x >= width || y < 0 || y >= height) return;
+    if (!inBounds(x, y)) return;
     
     int wallIndex = getIndex(x, y);
-    
-    // Remove all connections to this wall
-    for (auto& pair : adjacencyList) {
-        pair.second.erase(wallIndex);
-    }
-    
-    // Clear the wall's connections
-    adjacencyList[wallIndex].clear();
+    if (testWall(wallIndex)) return;
+
+    wallBits[wallIndex >> 6] |= uint64_t(1) << (wallIndex & 63);
+    wallCells.push_back(wallIndex);
+    layoutHash ^= cellKey(wallIndex);
+    revision++;
 }
 
 void Graph::removeWall(int x, int y) {
-    if (x < 0 || x >= width || y < 0 || y >= height) return;
+    if (!inBounds(x, y)) return;
     
     int current = getIndex(x, y);
-    adjacencyList[current].clear();
-    
-    // Restore connections
-    if (x > 0) {
-        int left = getIndex(x-1, y);
-        adjacencyList[current].insert(left);
-        adjacencyList[left].insert(current);
-    }
-    if (x < width-1) {
-        int right = getIndex(x+1, y);
-        adjacencyList[current].insert(right);
-        adjacencyList[right].insert(current);
-    }
-    if (y > 0) {
-        int up = getIndex(x, y-1);
-        adjacencyList[current].insert(up);
-        adjacencyList[up].insert(current);
-    }
-    if (y < height-1) {
-        int down = getIndex(x, y+1);
-        adjacencyList[current].insert(down);
-        adjacencyList[down].insert(current);
-    }
+    if (!testWall(current)) return;
+
+    wallBits[current >> 6] &= ~(uint64_t(1) << (current & 63));
+    *std::find(wallCells.begin(), wallCells.end(), current) = wallCells.back();
+    wallCells.pop_back();
+    layoutHash ^= cellKey(current);
+    revision++;
 }
 
 bool Graph::isValidMove(int fromX, int fromY, int toX, int toY) const {
-    if (toX < 0 || toX >= width || toY < 0 || toY >= height) return false;
+    if (!inBounds(fromX, fromY) || !inBounds(toX, toY)) return false;
+    if (std::abs(toX - fromX) + std::abs(toY - fromY) != 1) return false;
     
-    int fromIndex = getIndex(fromX, fromY);
-    int toIndex = getIndex(toX, toY);
-    
-    auto it = adjacencyList.find(fromIndex);
-    if (it != adjacencyList.end()) {
-        return it->second.count(toIndex) > 0;
-    }
-    return false;
+    return !testWall(getIndex(fromX, fromY)) && !testWall(getIndex(toX, toY));
 }
 
 bool Graph::isWall(int x, int y) const {
-    if (x < 0 || x >= width || y < 0 || y >= height) return true;
+    if (!inBounds(x, y)) return true;
     
-    int index = getIndex(x, y);
-    auto it = adjacencyList.find(index);
-    return it != adjacencyList.end() && it->second.empty();
+    return testWall(getIndex(x, y));
+}
+
+int Graph::getValidNeighbors(int x, int y, std::pair<int, int>* out) const {
+    if (isWall(x, y)) return 0;
+
+    int count = 0;
+    if (!isWall(x - 1, y)) out[count++] = {x - 1, y};
+    if (!isWall(x + 1, y)) out[count++] = {x + 1, y};
+    if (!isWall(x, y - 1)) out[count++] = {x, y - 1};
+    if (!isWall(x, y + 1)) out[count++] = {x, y + 1};
+    return count;
 }
 
 std::vector<std::pair<int, int>> Graph::getValidNeighbors(int x, int y) const {
-    std::vector<std::pair<int, int>> neighbors;
-    int currentIndex = getIndex(x, y);
-    
-    auto it = adjacencyList.find(currentIndex);
-    if (it != adjacencyList.end()) {
-        for (int neighborIndex : it->second) {
-            neighbors.push_back(getCoordinates(neighborIndex));
-        }
-    }
-    
-    return neighbors;
+    std::pair<int, int> buffer[4];
+    int count = getValidNeighbors(x, y, buffer);
+    return std::vector<std::pair<int, int>>(buffer, buffer + count);
 }
 
 void Graph::clearWalls() {
-    // Restore all connections
-    for (int x = 0; x < width; x++) {
-        for (int y = 0; y < height; y++) {
-            removeWall(x, y);
-        }
+    if (wallCells.empty()) return;
+
+    // Only touch the cells that were walled, not the whole grid
+    for (int cell : wallCells) {
+        wallBits[cell >> 6] &= ~(uint64_t(1) << (cell & 63));
     }
+    wallCells.clear();
+    layoutHash = 0;
+    revision++;
 }
 
 void Graph::generateWallLevel(int level) {
     clearWalls();
     
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    
     // Generate walls based on level
-    int wallCount = std::min(level * 3, (width * height) / 4);
+    int targetWalls = std::min(level * 3, (width * height) / 4);
     
-    for (int i = 0; i < wallCount; i++) {
-        int x = gen() % width;
-        int y = gen() % height;
+    for (int i = 0; i < targetWalls; i++) {
+        int x = rng.nextBelow(width);
+        int y = rng.nextBelow(height);
         
         // Don't place walls at starting position or too close to it
         if ((x < 3 && y < 3) || (x == width/2 && y == height/2)) {
@@ -133,4 +108,4 @@ void Graph::generateWallLevel(int level) {
         
         addWall(x, y);
     }
-}
\ No newline at end of file
+}
@@ -2,16 +2,32 @@
 #define GRAPH_H
 
 #include <vector>
-#include <unordered_map>
-#include <unordered_set>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include "Random.h"
 
+// Grid graph where every in-bounds, non-wall cell is connected to its four
+// orthogonal neighbours. Edges are implicit, so the only stored state is one
+// wall bit per cell plus a dense list of the walled cells.
 class Graph {
 private:
     int width, height;
-    std::unordered_map<int, std::unordered_set<int>> adjacencyList;
+    std::vector<uint64_t> wallBits;
+    // Dense list of walls, sized to the walls actually placed rather than the
+    // grid. Removal finds the wall's slot by scanning the list (levels remove
+    // walls rarely, and only clearWalls does it in bulk) and moves the last
+    // entry into the hole
+    std::vector<int> wallCells;
+    uint64_t layoutHash;            // XOR of a per-cell key over all walls
+    unsigned long long revision;    // Bumped by every wall mutation
+    Random rng;                     // Wall placement for generated levels
     
     int getIndex(int x, int y) const;
     std::pair<int, int> getCoordinates(int index) const;
+    bool inBounds(int x, int y) const { return x >= 0 && x < width && y >= 0 && y < height; }
+    bool testWall(int index) const { return (wallBits[index >> 6] >> (index & 63)) & 1; }
+    static uint64_t cellKey(int index);
 
 public:
     Graph(int w, int h);
@@ -20,8 +36,27 @@ public:
     bool isValidMove(int fromX, int fromY, int toX, int toY) const;
     bool isWall(int x, int y) const;
     std::vector<std::pair<int, int>> getValidNeighbors(int x, int y) const;
+    // Allocation-free variant: writes up to 4 neighbours into out, returns the count
+    int getValidNeighbors(int x, int y, std::pair<int, int>* out) const;
     void clearWalls();
     void generateWallLevel(int level);
+    // Restart the level generator; the same seed gives the same layouts
+    void seed(uint64_t value) { rng.seed(value); }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getWallCount() const { return static_cast<int>(wallCells.size()); }
+    // Calls f(x, y) once for every wall, in O(walls)
+    template <typename F>
+    void forEachWall(F f) const {
+        for (int cell : wallCells) {
+            f(cell % width, cell / width);
+        }
+    }
+    // Identifies the current wall layout; maintained incrementally in O(1)
+    uint64_t getLayoutHash() const { return layoutHash; }
+    // Changes whenever a wall is added or removed; caches of the wall layout
+    // compare it to know when to rebuild
+    unsigned long long getRevision() const { return revision; }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,362 @@
+#include "HamiltonianSolver.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+const int DX[4] = { 0, 0, -1, 1 };  // Indexed by Direction
+const int DY[4] = { -1, 1, 0, 0 };
+
+// Tree edge preferences while building around a body
+const char EDGE_REQUIRED = 0;
+const char EDGE_NEUTRAL = 1;
+const char EDGE_AVOIDED = 2;
+
+int findRoot(std::vector<int>& parent, int block) {
+    while (parent[block] != block) {
+        parent[block] = parent[parent[block]];
+        block = parent[block];
+    }
+    return block;
+}
+}
+
+HamiltonianSolver::HamiltonianSolver(int width, int height) :
+    width(width), height(height), currentHash(0), covered(false), fallback(width, height),
+    lastTick(0), alignedTicks(0), slack(0), slackValid(false), expectedPos(-1),
+    foodValid(false), foodRevision(0), foodPos(-1), foodHead(-1) {
+    long long cells = std::max(1LL, static_cast<long long>(width) * height);
+    cacheCapacity = static_cast<size_t>(std::max(1LL, std::min<long long>(MAX_CACHED_LAYOUTS, MAX_CACHED_CELLS / cells)));
+}
+
+std::shared_ptr<const CycleTable> HamiltonianSolver::build(const Graph& graph, const Snake& snake) const {
+    auto table = std::make_shared<CycleTable>();
+    size_t cellCount = static_cast<size_t>(width) * height;
+    table->order.assign(cellCount, -1);
+
+    // Blocks are 2x2 cell squares; usable when none of the 4 cells is a wall
+    int blocksX = width / 2;
+    int blocksY = height / 2;
+    int blockCount = blocksX * blocksY;
+    if (blockCount == 0) return table;
+
+    std::vector<char> usable(blockCount, 0);
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            int x = bx * 2, y = by * 2;
+            usable[by * blocksX + bx] = !graph.isWall(x, y) && !graph.isWall(x + 1, y) &&
+                                        !graph.isWall(x, y + 1) && !graph.isWall(x + 1, y + 1);
+        }
+    }
+
+    // Each block is a clockwise 4-cycle TL->TR->BR->BL. Joining two blocks
+    // along a tree edge swaps one edge of each, merging their cycles. So
+    // every body step says whether a side of its block should be joined;
+    // those edges go into the tree first and the ones it wants cut go in
+    // last. rightEdge[b] joins block b to its right neighbour, downEdge[b]
+    // the one below.
+    std::vector<char> rightEdge(blockCount, EDGE_NEUTRAL), downEdge(blockCount, EDGE_NEUTRAL);
+    SnakeBodyView body = snake.getBody();
+    for (int i = body.size() - 1; i > 0; i--) {
+        SnakeSegment from = body[i];
+        Direction side;
+        BlockLink link = LevelGenerator::classifyBlockLink(from, body[i - 1], side);
+        int bx = from.x >> 1, by = from.y >> 1;
+        if (link == BLOCK_LINK_NONE || bx >= blocksX || by >= blocksY) continue;
+        char want = link == BLOCK_LINK_JOINED ? EDGE_REQUIRED : EDGE_AVOIDED;
+        int block = by * blocksX + bx;
+        if (side == UP && by > 0) downEdge[block - blocksX] = want;
+        if (side == RIGHT && bx + 1 < blocksX) rightEdge[block] = want;
+        if (side == LEFT && bx > 0) rightEdge[block - 1] = want;
+        if (side == DOWN && by + 1 < blocksY) downEdge[block] = want;
+    }
+
+    // Spanning forest of the usable blocks by preference (union-find)
+    std::vector<int> parent(blockCount);
+    for (int block = 0; block < blockCount; block++) parent[block] = block;
+    std::vector<char> joinRight(blockCount, 0), joinDown(blockCount, 0);
+    for (char pass = EDGE_REQUIRED; pass <= EDGE_AVOIDED; pass++) {
+        for (int block = 0; block < blockCount; block++) {
+            if (!usable[block]) continue;
+            int bx = block % blocksX, by = block / blocksX;
+            if (bx + 1 < blocksX && rightEdge[block] == pass && usable[block + 1]) {
+                int a = findRoot(parent, block), b = findRoot(parent, block + 1);
+                if (a != b) {
+                    parent[a] = b;
+                    joinRight[block] = 1;
+                }
+            }
+            if (by + 1 < blocksY && downEdge[block] == pass && usable[block + blocksX]) {
+                int a = findRoot(parent, block), b = findRoot(parent, block + blocksX);
+                if (a != b) {
+                    parent[a] = b;
+                    joinDown[block] = 1;
+                }
+            }
+        }
+    }
+
+    // The cycle covers the largest tree
+    std::vector<int> treeSize(blockCount, 0);
+    int bestRoot = -1, bestSize = 0;
+    for (int block = 0; block < blockCount; block++) {
+        if (!usable[block]) continue;
+        int root = findRoot(parent, block);
+        if (++treeSize[root] > bestSize) {
+            bestSize = treeSize[root];
+            bestRoot = root;
+        }
+    }
+    if (bestRoot < 0) return table;
+
+    std::vector<int> next(cellCount, -1);
+    auto cell = [this](int x, int y) { return y * width + x; };
+    int start = -1;
+    for (int block = 0; block < blockCount; block++) {
+        if (!usable[block] || findRoot(parent, block) != bestRoot) continue;
+        int bx = block % blocksX, by = block / blocksX;
+        int x = bx * 2, y = by * 2;
+        bool up = by > 0 && joinDown[block - blocksX];
+        bool left = bx > 0 && joinRight[block - 1];
+        next[cell(x, y)] = up ? cell(x, y - 1) : cell(x + 1, y);
+        next[cell(x + 1, y)] = joinRight[block] ? cell(x + 2, y) : cell(x + 1, y + 1);
+        next[cell(x + 1, y + 1)] = joinDown[block] ? cell(x + 1, y + 2) : cell(x, y + 1);
+        next[cell(x, y + 1)] = left ? cell(x - 1, y + 1) : cell(x, y);
+        if (start < 0) start = cell(x, y);
+    }
+
+    table->cells.reserve(static_cast<size_t>(bestSize) * 4);
+    int walk = start;
+    do {
+        table->order[walk] = static_cast<int>(table->cells.size());
+        table->cells.push_back(walk);
+        walk = next[walk];
+    } while (walk != start);
+    table->length = static_cast<int>(table->cells.size());
+    return table;
+}
+
+bool HamiltonianSolver::liesAlong(const CycleTable& table, const Snake& snake) const {
+    SnakeBodyView body = snake.getBody();
+    int ahead = -1;
+    for (int i = 0; i < body.size(); i++) {
+        SnakeSegment segment = body[i];
+        if (segment.x < 0 || segment.x >= width || segment.y < 0 || segment.y >= height) return false;
+        int pos = table.order[segment.y * width + segment.x];
+        if (pos < 0 || (i > 0 && ahead != (pos + 1 == table.length ? 0 : pos + 1))) return false;
+        ahead = pos;
+    }
+    return true;
+}
+
+bool HamiltonianSolver::prepare(const Simulation& sim) {
+    const Graph& graph = sim.getGraph();
+    const Snake& snake = sim.getSnake();
+    uint64_t hash = graph.getLayoutHash();
+    if (current && hash == currentHash) return covered;
+
+    // A cached cycle was built around another body; it only serves if this
+    // one lies along it too
+    auto it = cache.find(hash);
+    if (it != cache.end() && liesAlong(*it->second, snake)) {
+        stats.cacheHits++;
+        current = it->second;
+    } else {
+        stats.cacheMisses++;
+        auto start = std::chrono::steady_clock::now();
+        current = build(graph, snake);
+        stats.lastBuildMillis = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+        if (it == cache.end() && cache.size() >= cacheCapacity) cache.clear();
+        cache[hash] = current;
+    }
+    currentHash = hash;
+    covered = current->length == width * height - graph.getWallCount();
+    stats.cycleLength = current->length;
+    // On cycle layouts the body carries straight on along the new cycle
+    alignedTicks = liesAlong(*current, snake) ? snake.getLength() : 0;
+    slackValid = false;
+    foodValid = false;
+    return covered;
+}
+
+bool HamiltonianSolver::isFree(const Simulation& sim, int x, int y) const {
+    if (sim.getGraph().isWall(x, y)) return false;
+
+    // The tail cell is vacated on the next move, unless the snake is growing
+    const Snake& snake = sim.getSnake();
+    if (!snake.checkCollision(x, y)) return true;
+    SnakeSegment tail = snake.getTail();
+    return !snake.isGrowing() && tail.x == x && tail.y == y;
+}
+
+int HamiltonianSolver::cycleDistance(int from, int to) const {
+    int distance = to - from;
+    return distance < 0 ? distance + current->length : distance;
+}
+
+// Following the cycle from entryPos (entered next tick), the head reaches a
+// body cell at position p after 1 + distance(entryPos, p) ticks; segment i
+// (0 = head) is gone after length - i ticks, one more while growing. The
+// smallest difference over the body is the slack; it stays the same while
+// the snake follows the cycle and drops by one for each food eaten.
+int HamiltonianSolver::followSlack(const Simulation& sim, int entryPos) const {
+    const Snake& snake = sim.getSnake();
+    SnakeBodyView body = snake.getBody();
+    int length = body.size();
+    int growth = snake.isGrowing() ? 1 : 0;
+    int result = current->length;
+    for (int i = 0; i < length; i++) {
+        int pos = current->order[body[i].y * width + body[i].x];
+        if (pos < 0) continue;
+        result = std::min(result, 1 + cycleDistance(entryPos, pos) - (length - i) - growth);
+    }
+    return result;
+}
+
+int HamiltonianSolver::nearestFood(const Simulation& sim, int headPos) {
+    // With the food unchanged and the head still short of the last answer,
+    // nothing can have appeared between them
+    const Food& food = sim.getFood();
+    if (foodValid && food.getRevision() == foodRevision &&
+        (foodPos < 0 || cycleDistance(headPos, foodPos) <= cycleDistance(foodHead, foodPos))) {
+        foodHead = headPos;
+        return foodPos;
+    }
+
+    // Scan forward to the first food; the snake will cover that stretch
+    // anyway, so the cost is spread over the ticks it takes
+    const CycleTable& table = *current;
+    foodValid = true;
+    foodRevision = food.getRevision();
+    foodHead = headPos;
+    foodPos = -1;
+    if (food.getCount() == 0) return foodPos;
+    for (int step = 1, pos = headPos + 1; step < current->length; step++, pos++) {
+        if (pos == current->length) pos = 0;
+        if (food.contains(table.cells[pos] % width, table.cells[pos] / width)) {
+            foodPos = pos;
+            break;
+        }
+    }
+    return foodPos;
+}
+
+Direction HamiltonianSolver::toward(const Simulation& sim, int cell) const {
+    SnakeSegment head = sim.getSnake().getHead();
+    int tx = cell % width, ty = cell / width;
+    for (int d = 0; d < 4; d++) {
+        if (head.x + DX[d] == tx && head.y + DY[d] == ty) return static_cast<Direction>(d);
+    }
+    return sim.getSnake().getDirection();
+}
+
+// Off the cycle, or its successor is unsafe: step onto the neighbouring
+// cycle cell with the most slack, or let the greedy search take over
+Direction HamiltonianSolver::rejoin(const Simulation& sim) {
+    SnakeSegment head = sim.getSnake().getHead();
+    int bestSlack = -1, bestCell = -1;
+    for (int d = 0; d < 4; d++) {
+        int nx = head.x + DX[d], ny = head.y + DY[d];
+        if (!isFree(sim, nx, ny)) continue;
+        int pos = current->order[ny * width + nx];
+        if (pos < 0) continue;
+        int candidate = followSlack(sim, pos);
+        if (candidate > bestSlack) {
+            bestSlack = candidate;
+            bestCell = ny * width + nx;
+        }
+    }
+    alignedTicks = 0;
+    if (bestCell < 0) {
+        stats.fallbacks++;
+        slackValid = false;
+        return fallback.decide(sim);
+    }
+    stats.rejoins++;
+    slack = bestSlack;
+    slackValid = true;
+    expectedPos = current->order[bestCell];
+    return toward(sim, bestCell);
+}
+
+Direction HamiltonianSolver::decide(const Simulation& sim) {
+    prepare(sim);
+
+    // A gap in ticks means a new game or another controller moved the snake
+    unsigned long long tick = sim.getTickCount();
+    if (tick != lastTick + 1 && tick != lastTick) {
+        alignedTicks = 0;
+        slackValid = false;
+    }
+    lastTick = tick + 1;
+
+    if (!covered) {
+        stats.fallbacks++;
+        return fallback.decide(sim);
+    }
+    const Snake& snake = sim.getSnake();
+    SnakeSegment head = snake.getHead();
+    const CycleTable& table = *current;
+    int headPos = sim.getGraph().isWall(head.x, head.y) ? -1 : table.order[head.y * width + head.x];
+    if (headPos < 0) return rejoin(sim);
+    int foodAhead = nearestFood(sim, headPos);
+
+    int successorPos = headPos + 1 == current->length ? 0 : headPos + 1;
+    int successor = table.cells[successorPos];
+    if (!isFree(sim, successor % width, successor / width)) return rejoin(sim);
+
+    if (alignedTicks < snake.getLength()) {
+        // The body is not laid along the cycle yet: follow it only while
+        // every body cell ahead on it is gone before the head gets there. The
+        // running slack only falls; once the cell that set it is gone the
+        // real one can be larger, so it is measured again before giving up.
+        if (slackValid && headPos == expectedPos && snake.isGrowing()) slack--;
+        if (!slackValid || headPos != expectedPos || slack < 0) {
+            slack = followSlack(sim, successorPos);
+            slackValid = true;
+        }
+        if (slack < 0) return rejoin(sim);
+        alignedTicks++;
+        expectedPos = successorPos;
+        return toward(sim, successor);
+    }
+
+    int targetCell = successor;
+    int bestDistance = 1;
+    SnakeSegment tail = snake.getTail();
+    int tailPos = current->order[tail.y * width + tail.x];
+    slackValid = false;
+
+    // Shortcuts are only safe once the body lies in cycle order, and are
+    // disabled for the second half of the game so the snake does not cut
+    // off the cycle ahead of its own tail. The only step off the cycle that
+    // keeps the body on some block cycle is the one along the head's block,
+    // leaving out the blocks hung on the side the head faces; any other would
+    // leave a step in the body that the next level's cycle could not keep.
+    if (tailPos >= 0 && foodAhead >= 0 && snake.getLength() < current->length / 2) {
+        int tailDistance = cycleDistance(headPos, tailPos);
+        int foodDistance = cycleDistance(headPos, foodAhead);
+
+        for (int d = 0; d < 4; d++) {
+            int nx = head.x + DX[d], ny = head.y + DY[d];
+            Direction side;
+            if (!isFree(sim, nx, ny) ||
+                LevelGenerator::classifyBlockLink(head, SnakeSegment(nx, ny), side) != BLOCK_LINK_CUT) continue;
+            int pos = current->order[ny * width + nx];
+            if (pos < 0) continue;
+
+            int distance = cycleDistance(headPos, pos);
+            if (distance > bestDistance && distance <= foodDistance &&
+                distance < tailDistance - SHORTCUT_SLACK) {
+                bestDistance = distance;
+                targetCell = ny * width + nx;
+            }
+        }
+        if (bestDistance > 1) stats.shortcuts++;
+    }
+
+    alignedTicks++;
+    expectedPos = current->order[targetCell];
+    return toward(sim, targetCell);
+}
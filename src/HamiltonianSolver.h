@@ -0,0 +1,90 @@
+#ifndef HAMILTONIANSOLVER_H
+#define HAMILTONIANSOLVER_H
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include "Simulation.h"
+#include "Autopilot.h"
+
+// Hamiltonian cycle over one wall layout. order[cell] is the cell's position
+// on the cycle (-1 if the cycle does not visit it), cells[pos] the inverse.
+struct CycleTable {
+    std::vector<int> order;
+    std::vector<int> cells;
+    int length = 0;
+};
+
+struct HamiltonianStats {
+    unsigned long long cacheHits = 0;
+    unsigned long long cacheMisses = 0;
+    unsigned long long shortcuts = 0;
+    unsigned long long rejoins = 0;     // Moves back onto the cycle off its successor
+    unsigned long long fallbacks = 0;   // Ticks handed to the greedy autopilot
+    double lastBuildMillis = 0;
+    int cycleLength = 0;
+};
+
+// Cycle-following AI: follows a Hamiltonian cycle and takes shortcuts toward
+// food only when they cannot overtake the tail. Cycles are built from a
+// spanning tree of wall-free 2x2 blocks and cached by Graph::getLayoutHash(),
+// so once prepare() has run for a layout each decision is a handful of table
+// lookups.
+//
+// The cycle visits every free cell when the walls cover whole blocks, which
+// Simulation::setCycleLayouts() guarantees; prepare() returns false for any
+// other layout, and decide() then hands every tick to the greedy autopilot.
+// Each cycle is built around the current body, keeping every step of it a
+// block cycle can have. On cycle layouts the generator leaves room for all of
+// them, so a body that lay along the old cycle lies along the new one and the
+// snake goes on to fill the board. Until the body lies along the cycle (a new
+// game, or after another controller), the snake only follows it while every
+// body cell on it is vacated before the head arrives, and otherwise steps onto
+// the neighbouring cycle cell with the most slack.
+class HamiltonianSolver {
+private:
+    static const int MAX_CACHED_LAYOUTS = 64;
+    static const int MAX_CACHED_CELLS = 1 << 22;    // Bounds cache memory (8 bytes per cell)
+    static const int SHORTCUT_SLACK = 4;    // Room left for growth behind a shortcut
+
+    int width, height;
+    std::unordered_map<uint64_t, std::shared_ptr<const CycleTable>> cache;
+    std::shared_ptr<const CycleTable> current;
+    uint64_t currentHash;
+    bool covered;           // The current cycle visits every free cell
+    Autopilot fallback;
+    HamiltonianStats stats;
+    unsigned long long lastTick;
+    int alignedTicks;       // Consecutive ticks spent on the cycle
+    int slack;              // Spare ticks of the body ahead on the cycle, while not aligned
+    bool slackValid;
+    int expectedPos;        // Cycle position the last decision moved to
+    // Nearest food ahead on the cycle, rescanned from the head only when the
+    // food changes or the head did not simply follow the cycle toward it
+    bool foodValid;
+    unsigned long long foodRevision;
+    int foodPos;            // -1 when no food is on the cycle
+    int foodHead;           // Head position at the last check
+    size_t cacheCapacity;   // Layouts kept; fewer on large boards
+
+    std::shared_ptr<const CycleTable> build(const Graph& graph, const Snake& snake) const;
+    bool liesAlong(const CycleTable& table, const Snake& snake) const;
+    bool isFree(const Simulation& sim, int x, int y) const;
+    int cycleDistance(int from, int to) const;
+    int followSlack(const Simulation& sim, int entryPos) const;
+    int nearestFood(const Simulation& sim, int headPos);
+    Direction rejoin(const Simulation& sim);
+    Direction toward(const Simulation& sim, int cell) const;
+
+public:
+    HamiltonianSolver(int width, int height);
+    // Look up (or build around the current body and cache) the cycle for the
+    // board's current wall layout; false when it cannot visit every free cell
+    bool prepare(const Simulation& sim);
+    Direction decide(const Simulation& sim);
+    const HamiltonianStats& getStats() const { return stats; }
+    const Autopilot& getFallback() const { return fallback; }
+};
+
+#endif
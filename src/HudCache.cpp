@@ -0,0 +1,92 @@
+#include "HudCache.h"
+
+HudCache::HudCache(const sf::Font& font) : font(font), relayouts(0) {}
+
+void HudCache::applyStyle(sf::Text& text, unsigned size, sf::Color color) const {
+    text.setFont(font);
+    text.setCharacterSize(size);
+    text.setFillColor(color);
+    text.setOutlineColor(sf::Color::Black);
+    text.setOutlineThickness(2);
+    text.setStyle(sf::Text::Bold);
+}
+
+HudCache::Slot& HudCache::getSlot(int id, float x, float y, unsigned size, sf::Color color) {
+    if (id >= static_cast<int>(slots.size())) {
+        slots.resize(id + 1);
+    }
+
+    Slot& slot = slots[id];
+    if (!slot.initialised || slot.size != size || slot.color != color) {
+        applyStyle(slot.text, size, color);
+        slot.initialised = true;
+        slot.size = size;
+        slot.color = color;
+    }
+    if (slot.x != x || slot.y != y) {
+        slot.text.setPosition(x, y);
+        slot.x = x;
+        slot.y = y;
+    }
+    return slot;
+}
+
+HudCache::Panel& HudCache::getPanel(int id, const sf::FloatRect& area) {
+    if (id >= static_cast<int>(panels.size())) {
+        panels.resize(id + 1);
+    }
+
+    if (!panels[id]) {
+        panels[id].reset(new Panel());
+        Panel& panel = *panels[id];
+        panel.offscreen = panel.texture.create(static_cast<unsigned>(area.width),
+                                               static_cast<unsigned>(area.height));
+        if (panel.offscreen) {
+            // Build callbacks draw in window coordinates
+            panel.texture.setView(sf::View(area));
+            panel.sprite.setTexture(panel.texture.getTexture());
+            panel.sprite.setPosition(area.left, area.top);
+        }
+    }
+    return *panels[id];
+}
+
+void HudCache::drawText(sf::RenderTarget& target, int slot, const char* text, float x, float y,
+                        unsigned size, sf::Color color) {
+    Slot& entry = getSlot(slot, x, y, size, color);
+    if (entry.hasValue || entry.shown != text) {
+        entry.shown = text;
+        entry.hasValue = false;
+        entry.text.setString(entry.shown);
+        relayouts++;
+    }
+    target.draw(entry.text);
+}
+
+void HudCache::drawValue(sf::RenderTarget& target, int slot, const char* label, long long value,
+                         float x, float y, unsigned size, sf::Color color) {
+    Slot& entry = getSlot(slot, x, y, size, color);
+    if (!entry.hasValue || entry.value != value) {
+        entry.shown = label;
+        entry.shown += std::to_string(value);
+        entry.value = value;
+        entry.hasValue = true;
+        entry.text.setString(entry.shown);
+        relayouts++;
+    }
+    target.draw(entry.text);
+}
+
+void HudCache::drawOnce(sf::RenderTarget& target, const std::string& text, float x, float y,
+                        unsigned size, sf::Color color) {
+    applyStyle(scratch, size, color);
+    scratch.setString(text);
+    scratch.setPosition(x, y);
+    target.draw(scratch);
+}
+
+void HudCache::invalidatePanels() {
+    for (auto& panel : panels) {
+        if (panel) panel->valid = false;
+    }
+}
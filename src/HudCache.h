@@ -0,0 +1,81 @@
+#ifndef HUDCACHE_H
+#define HUDCACHE_H
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <string>
+#include <memory>
+
+// Text rendering cache for the HUD and menu screens.
+//  - Slots: persistent sf::Text objects keyed by an integer id. A slot only
+//    re-lays-out its glyphs (and builds a string) when its value changes.
+//  - Panels: static screens pre-rendered once into an sf::RenderTexture and
+//    drawn as a single sprite until their key changes.
+class HudCache {
+private:
+    struct Slot {
+        sf::Text text;
+        std::string shown;
+        long long value = 0;
+        bool hasValue = false;
+        bool initialised = false;
+        float x = 0, y = 0;
+        unsigned size = 0;
+        sf::Color color;
+    };
+    struct Panel {
+        sf::RenderTexture texture;
+        sf::Sprite sprite;
+        unsigned long long key = 0;
+        bool valid = false;
+        bool offscreen = false;     // False if the render texture could not be created
+    };
+
+    const sf::Font& font;
+    std::vector<Slot> slots;
+    std::vector<std::unique_ptr<Panel>> panels;
+    sf::Text scratch;
+    unsigned long long relayouts;
+
+    void applyStyle(sf::Text& text, unsigned size, sf::Color color) const;
+    Slot& getSlot(int id, float x, float y, unsigned size, sf::Color color);
+    Panel& getPanel(int id, const sf::FloatRect& area);
+
+public:
+    explicit HudCache(const sf::Font& font);
+    void drawText(sf::RenderTarget& target, int slot, const char* text, float x, float y,
+                  unsigned size, sf::Color color = sf::Color::White);
+    // Draws label followed by value, formatting only when value changes
+    void drawValue(sf::RenderTarget& target, int slot, const char* label, long long value,
+                   float x, float y, unsigned size, sf::Color color = sf::Color::White);
+    // Uncached styled text, for building panels
+    void drawOnce(sf::RenderTarget& target, const std::string& text, float x, float y,
+                  unsigned size, sf::Color color = sf::Color::White);
+
+    // Draws panel `id` covering `area` (window coordinates). build(target) is
+    // only called when the panel is first used or `key` differs from the key
+    // it was last rendered with.
+    template <typename F>
+    void drawPanel(sf::RenderTarget& target, int id, unsigned long long key,
+                   const sf::FloatRect& area, F build) {
+        Panel& panel = getPanel(id, area);
+        if (!panel.offscreen) {
+            build(target);
+            return;
+        }
+        if (!panel.valid || panel.key != key) {
+            panel.texture.clear(sf::Color::Transparent);
+            build(panel.texture);
+            panel.texture.display();
+            panel.valid = true;
+            panel.key = key;
+        }
+        target.draw(panel.sprite);
+    }
+
+    void invalidatePanels();
+    // Number of times a slot had to rebuild its string and glyph layout
+    unsigned long long getRelayoutCount() const { return relayouts; }
+};
+
+#endif
@@ -0,0 +1,44 @@
+#include "InputQueue.h"
+#include <algorithm>
+
+namespace {
+bool isReversal(Direction a, Direction b) {
+    return (a == UP && b == DOWN) || (a == DOWN && b == UP) ||
+           (a == LEFT && b == RIGHT) || (a == RIGHT && b == LEFT);
+}
+}
+
+void LatencyStats::add(double millis) {
+    samples++;
+    lastMillis = millis;
+    maxMillis = std::max(maxMillis, millis);
+    averageMillis += (millis - averageMillis) / samples;
+}
+
+InputQueue::InputQueue() : head(0), count(0), dropped(0) {}
+
+bool InputQueue::push(Direction dir, unsigned long long timestampMicros, Direction current) {
+    Direction last = count > 0 ? items[(head + count - 1) % CAPACITY].direction : current;
+    if (dir == last || isReversal(last, dir) || count == CAPACITY) {
+        dropped++;
+        return false;
+    }
+
+    items[(head + count) % CAPACITY] = TimedInput{ dir, timestampMicros };
+    count++;
+    return true;
+}
+
+bool InputQueue::pop(TimedInput& out) {
+    if (count == 0) return false;
+
+    out = items[head];
+    head = (head + 1) % CAPACITY;
+    count--;
+    return true;
+}
+
+void InputQueue::clear() {
+    head = 0;
+    count = 0;
+}
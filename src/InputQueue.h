@@ -0,0 +1,43 @@
+#ifndef INPUTQUEUE_H
+#define INPUTQUEUE_H
+
+#include "Snake.h"
+
+struct TimedInput {
+    Direction direction;
+    unsigned long long timestampMicros;     // When the key event arrived
+};
+
+// Running latency summary (last / average / max), in milliseconds
+struct LatencyStats {
+    double lastMillis = 0;
+    double averageMillis = 0;
+    double maxMillis = 0;
+    unsigned long long samples = 0;
+
+    void add(double millis);
+};
+
+// Bounded FIFO of turns, consumed one per tick. A turn is validated against
+// the last queued heading rather than the snake's current one, so quick
+// sequences such as UP then LEFT within one tick both take effect.
+class InputQueue {
+private:
+    static const int CAPACITY = 4;
+    TimedInput items[CAPACITY];
+    int head;
+    int count;
+    unsigned long long dropped;
+
+public:
+    InputQueue();
+    // current is the heading the snake will move in if nothing is queued.
+    // Reversals, repeats and turns beyond capacity are dropped (returns false).
+    bool push(Direction dir, unsigned long long timestampMicros, Direction current);
+    bool pop(TimedInput& out);
+    void clear();
+    int size() const { return count; }
+    unsigned long long getDroppedCount() const { return dropped; }
+};
+
+#endif
@@ -0,0 +1,370 @@
+#include "LevelGenerator.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+namespace {
+// The 8 neighbours in ring order, starting north and going clockwise.
+// Even positions are the orthogonal (4-connected) neighbours.
+const int RING_X[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+const int RING_Y[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+const int DX[4] = { 0, 0, -1, 1 };  // Indexed by Direction
+const int DY[4] = { -1, 1, 0, 0 };
+const int LATTICE_TILE = 64;        // Cells per side of a shuffling tile
+
+// Cells of one lattice wall segment, placed together
+struct Segment {
+    int x, y;
+    int dx, dy;
+    int length;
+};
+}
+
+LevelGenerator::LevelGenerator(int width, int height) :
+    width(width), height(height), rng(std::random_device{}()), cycleLayouts(false) {
+    // Scratch lives as long as the generator: only wall cells' union-find
+    // entries are ever read, and each is set when its wall is placed
+    size_t cells = static_cast<size_t>(width) * height;
+    parent.resize(cells + 1);
+    rank.resize(cells + 1);
+    reserved.assign(cells, 0);
+}
+
+int LevelGenerator::find(int node) {
+    while (parent[node] != node) {
+        parent[node] = parent[parent[node]];
+        node = parent[node];
+    }
+    return node;
+}
+
+void LevelGenerator::unite(int a, int b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) return;
+    if (rank[a] < rank[b]) std::swap(a, b);
+    parent[b] = a;
+    if (rank[a] == rank[b]) rank[a]++;
+}
+
+bool LevelGenerator::tryPlace(Graph& graph, int x, int y) {
+    if (x < 0 || x >= width || y < 0 || y >= height) return false;
+    int index = y * width + x;
+    if (reserved[index] || graph.isWall(x, y)) return false;
+
+    // Classify the ring: blocked (wall or off the board) or open. node[i]
+    // is the union-find node of a blocked neighbour.
+    bool blocked[8];
+    int node[8];
+    for (int i = 0; i < 8; i++) {
+        int nx = x + RING_X[i];
+        int ny = y + RING_Y[i];
+        if (nx < 0 || nx >= width || ny < 0 || ny >= height) {
+            blocked[i] = true;
+            node[i] = borderNode();
+        } else {
+            blocked[i] = graph.isWall(nx, ny);
+            node[i] = ny * width + nx;
+        }
+    }
+
+    // An open corner between two blocked sides does not touch this cell
+    // 4-wise, so it cannot join the open runs on either side; treat it as
+    // part of the gap
+    bool gap[8];
+    for (int i = 0; i < 8; i++) {
+        gap[i] = blocked[i] || (i % 2 == 1 && blocked[i - 1] && blocked[(i + 1) % 8]);
+    }
+
+    // Walk the ring once from the start of a gap, keeping one blocked
+    // neighbour per gap; neighbours within a gap touch each other, so they
+    // are already in the same component
+    int gapNodes[4];
+    int gapCount = 0;
+    int start = -1;
+    for (int i = 0; i < 8; i++) {
+        if (gap[i] && !gap[(i + 7) % 8]) {
+            start = i;
+            break;
+        }
+    }
+    if (start >= 0) {
+        for (int step = 0; step < 8; step++) {
+            int i = (start + step) % 8;
+            if (!gap[i]) continue;
+            if (!gap[(i + 7) % 8]) gapNodes[gapCount++] = -1;
+            if (blocked[i] && gapNodes[gapCount - 1] < 0) gapNodes[gapCount - 1] = node[i];
+        }
+    } else if (blocked[0]) {
+        // Fully enclosed: one gap all the way round
+        gapNodes[gapCount++] = node[0];
+    }
+
+    // Two gaps already joined elsewhere: this wall would close the loop.
+    // With a single gap there is nothing to look up.
+    if (gapCount > 1) {
+        for (int a = 0; a < gapCount; a++) gapNodes[a] = find(gapNodes[a]);
+        for (int a = 0; a < gapCount; a++) {
+            for (int b = a + 1; b < gapCount; b++) {
+                if (gapNodes[a] == gapNodes[b]) {
+                    stats.rejected++;
+                    return false;
+                }
+            }
+        }
+    }
+
+    graph.addWall(x, y);
+    parent[index] = index;
+    rank[index] = 0;
+    for (int a = 0; a < gapCount; a++) unite(index, gapNodes[a]);
+    stats.placed++;
+    return true;
+}
+
+void LevelGenerator::reserve(int x, int y) {
+    if (x < 0 || x >= width || y < 0 || y >= height) return;
+    int index = y * width + x;
+    if (reserved[index]) return;
+    reserved[index] = 1;
+    reservedCells.push_back(index);
+}
+
+void LevelGenerator::reserveSnake(const Snake& snake) {
+    for (const auto& segment : snake.getBody()) {
+        reserve(segment.x, segment.y);
+    }
+
+    // Keep the head's neighbours and a short run straight ahead open, so a
+    // new level never puts a wall right in front of the snake
+    SnakeSegment head = snake.getHead();
+    for (int d = 0; d < 4; d++) {
+        reserve(head.x + DX[d], head.y + DY[d]);
+    }
+    Direction heading = snake.getDirection();
+    for (int step = 2; step <= 4; step++) {
+        reserve(head.x + DX[heading] * step, head.y + DY[heading] * step);
+    }
+}
+
+void LevelGenerator::placeScattered(Graph& graph, int level, bool mirrored) {
+    // Same density as the original 30x20 board: level * 3 walls per 600 cells
+    long long cells = static_cast<long long>(width) * height;
+    long long target = std::min(static_cast<long long>(level) * 3 * std::max(1LL, cells / 600), cells / 4);
+    long long attempts = target * 4;
+
+    while (stats.placed < target && attempts-- > 0) {
+        int x = rng.nextBelow(width);
+        int y = rng.nextBelow(height);
+        tryPlace(graph, x, y);
+        if (mirrored) {
+            tryPlace(graph, width - 1 - x, y);
+            tryPlace(graph, x, height - 1 - y);
+            tryPlace(graph, width - 1 - x, height - 1 - y);
+        }
+    }
+}
+
+void LevelGenerator::placeLattice(Graph& graph, int spacing, int extraDoorsPercent) {
+    // Wall lines every `spacing` cells, cut into segments between crossings.
+    // Segments go in random order within each tile and tiles in turn: just
+    // as random at the scale of a room, but the union-find and wall bits
+    // stay in cache instead of being touched all over a large board.
+    std::vector<Segment> segments;
+    for (int tileY = 0; tileY < height; tileY += LATTICE_TILE) {
+        for (int tileX = 0; tileX < width; tileX += LATTICE_TILE) {
+            int tileRight = std::min(tileX + LATTICE_TILE, width);
+            int tileBottom = std::min(tileY + LATTICE_TILE, height);
+            int firstX = (tileX + spacing - 1) / spacing * spacing;
+            int firstY = (tileY + spacing - 1) / spacing * spacing;
+            segments.clear();
+            for (int y = std::max(firstY, spacing); y < tileBottom; y += spacing) {
+                for (int x = firstX; x < tileRight; x += spacing) {
+                    segments.push_back(Segment{x, y, 1, 0, std::min(spacing, width - x)});
+                }
+            }
+            for (int x = std::max(firstX, spacing); x < tileRight; x += spacing) {
+                for (int y = firstY; y < tileBottom; y += spacing) {
+                    segments.push_back(Segment{x, y, 0, 1, std::min(spacing, height - y)});
+                }
+            }
+            for (size_t i = segments.size(); i > 1; i--) {
+                std::swap(segments[i - 1], segments[rng.nextBelow(static_cast<int>(i))]);
+            }
+
+            // Whatever would close a loop is rejected and becomes a doorway;
+            // extra gaps make loops so there is more than one way around
+            for (const Segment& segment : segments) {
+                int skip = rng.nextBelow(100) < extraDoorsPercent ? 1 + rng.nextBelow(std::max(1, segment.length - 1)) : -1;
+                for (int i = 0; i < segment.length; i++) {
+                    if (i == skip) continue;
+                    tryPlace(graph, segment.x + segment.dx * i, segment.y + segment.dy * i);
+                }
+            }
+        }
+    }
+}
+
+void LevelGenerator::placeBlocks(Graph& graph, int level, LevelStyle style, const Snake* snake) {
+    int blocksX = width / 2;
+    int blocksY = height / 2;
+    if (!blocks) {
+        blocks.reset(new LevelGenerator(blocksX, blocksY));
+        blockGraph.reset(new Graph(blocksX, blocksY));
+    }
+
+    // The block layout draws from this generator's sequence, and a block
+    // holding a reserved cell stays open. Scattered walls come four cells at
+    // a time, so a quarter as many keep the density.
+    blocks->rng.setState(rng.getState());
+    for (int index : reservedCells) {
+        blocks->reserve(index % width / 2, index / width / 2);
+    }
+    bool scattered = style == LEVEL_RANDOM || style == LEVEL_SYMMETRIC;
+    blocks->generate(*blockGraph, scattered ? (level + 3) / 4 : level, style);
+    rng.setState(blocks->rng.getState());
+    stats.rejected = blocks->stats.rejected;
+
+    blockGraph->forEachWall([&graph](int bx, int by) {
+        graph.addWall(bx * 2, by * 2);
+        graph.addWall(bx * 2 + 1, by * 2);
+        graph.addWall(bx * 2, by * 2 + 1);
+        graph.addWall(bx * 2 + 1, by * 2 + 1);
+    });
+    // An odd last row or column belongs to no block
+    for (int y = 0; width % 2 && y < height; y++) {
+        if (!snake || !snake->checkCollision(width - 1, y)) graph.addWall(width - 1, y);
+    }
+    for (int x = 0; height % 2 && x < width; x++) {
+        if (!snake || !snake->checkCollision(x, height - 1)) graph.addWall(x, height - 1);
+    }
+}
+
+// The blocks connect without crossing a wall, but the next cycle must also
+// keep every side the body runs along cut. Free blocks the head cannot reach
+// without crossing such a side would be left off the cycle, so they are
+// walled. Runs over the free blocks; building the cycle costs as much.
+void LevelGenerator::sealCutBlocks(Graph& graph, const Snake& snake) {
+    int blocksX = width / 2;
+    int blocksY = height / 2;
+    SnakeSegment head = snake.getHead();
+    if (head.x < 0 || head.y < 0 || head.x / 2 >= blocksX || head.y / 2 >= blocksY) return;
+    blockCuts.resize(static_cast<size_t>(blocksX) * blocksY);
+    blockSeen.resize(blockCuts.size());
+
+    SnakeBodyView body = snake.getBody();
+    for (int i = body.size() - 1; i > 0; i--) {
+        Direction side;
+        if (classifyBlockLink(body[i], body[i - 1], side) != BLOCK_LINK_CUT) continue;
+        int bx = body[i].x / 2, by = body[i].y / 2;
+        if (bx >= blocksX || by >= blocksY) continue;
+        int block = by * blocksX + bx;
+        if (side == RIGHT && bx + 1 < blocksX) blockCuts[block] |= 1;
+        if (side == LEFT && bx > 0) blockCuts[block - 1] |= 1;
+        if (side == DOWN && by + 1 < blocksY) blockCuts[block] |= 2;
+        if (side == UP && by > 0) blockCuts[block - blocksX] |= 2;
+    }
+
+    blockQueue.clear();
+    int start = head.y / 2 * blocksX + head.x / 2;
+    blockSeen[start] = 1;
+    blockQueue.push_back(start);
+    for (size_t i = 0; i < blockQueue.size(); i++) {
+        int block = blockQueue[i];
+        int bx = block % blocksX, by = block / blocksX;
+        int next[4] = {
+            bx + 1 < blocksX && !(blockCuts[block] & 1) ? block + 1 : -1,
+            bx > 0 && !(blockCuts[block - 1] & 1) ? block - 1 : -1,
+            by + 1 < blocksY && !(blockCuts[block] & 2) ? block + blocksX : -1,
+            by > 0 && !(blockCuts[block - blocksX] & 2) ? block - blocksX : -1,
+        };
+        for (int neighbour : next) {
+            if (neighbour < 0 || blockSeen[neighbour] || blockGraph->isWall(neighbour % blocksX, neighbour / blocksX)) continue;
+            blockSeen[neighbour] = 1;
+            blockQueue.push_back(neighbour);
+        }
+    }
+
+    // Only when the body does not lie along a block cycle can part of it end
+    // up out of reach; it stays open
+    int freeBlocks = blocksX * blocksY - blockGraph->getWallCount();
+    for (int block = 0; static_cast<int>(blockQueue.size()) < freeBlocks && block < blocksX * blocksY; block++) {
+        int x = block % blocksX * 2, y = block / blocksX * 2;
+        if (blockSeen[block] || graph.isWall(x, y)) continue;
+        if (snake.checkCollision(x, y) || snake.checkCollision(x + 1, y) ||
+            snake.checkCollision(x, y + 1) || snake.checkCollision(x + 1, y + 1)) continue;
+        graph.addWall(x, y);
+        graph.addWall(x + 1, y);
+        graph.addWall(x, y + 1);
+        graph.addWall(x + 1, y + 1);
+    }
+
+    for (int block : blockQueue) blockSeen[block] = 0;
+    for (int i = body.size() - 1; i > 0; i--) {
+        int bx = body[i].x / 2, by = body[i].y / 2;
+        if (body[i].x < 0 || body[i].y < 0 || bx >= blocksX || by >= blocksY) continue;
+        int block = by * blocksX + bx;
+        blockCuts[block] = 0;
+        if (bx > 0) blockCuts[block - 1] = 0;
+        if (by > 0) blockCuts[block - blocksX] = 0;
+    }
+}
+
+void LevelGenerator::generate(Graph& graph, int level, LevelStyle style, const Snake* snake) {
+    auto start = std::chrono::steady_clock::now();
+    stats = LevelStats();
+    graph.clearWalls();
+
+    parent[borderNode()] = borderNode();
+    rank[borderNode()] = 0;
+    if (snake) reserveSnake(*snake);
+
+    if (cycleLayouts) {
+        placeBlocks(graph, level, style, snake);
+        if (snake) sealCutBlocks(graph, *snake);
+        stats.placed = graph.getWallCount();
+    } else {
+        switch (style) {
+            case LEVEL_RANDOM:
+                placeScattered(graph, level, false);
+                break;
+            case LEVEL_SYMMETRIC:
+                placeScattered(graph, level, true);
+                break;
+            case LEVEL_MAZE:
+                // Corridors narrow from 4 cells wide to 2 as levels go up
+                placeLattice(graph, std::max(3, 5 - level / 3), 0);
+                break;
+            case LEVEL_ROOMS:
+                // Room interiors shrink from 14 cells across to 6
+                placeLattice(graph, std::max(7, 16 - level), 50);
+                break;
+            default:
+                break;
+        }
+    }
+
+    for (int index : reservedCells) reserved[index] = 0;
+    reservedCells.clear();
+
+    stats.millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+BlockLink LevelGenerator::classifyBlockLink(const SnakeSegment& from, const SnakeSegment& to, Direction& side) {
+    // Indexed by corner: 0 top left, 1 top right, 2 bottom left, 3 bottom right
+    static const Direction FACING[4] = { UP, RIGHT, LEFT, DOWN };
+    static const int ALONG_X[4] = { 1, 0, 0, -1 };
+    static const int ALONG_Y[4] = { 0, 1, -1, 0 };
+    if (from.x < 0 || from.y < 0) return BLOCK_LINK_NONE;
+
+    int corner = ((from.y & 1) << 1) | (from.x & 1);
+    side = FACING[corner];
+    if (to.x == from.x + DX[side] && to.y == from.y + DY[side]) return BLOCK_LINK_JOINED;
+    if (to.x == from.x + ALONG_X[corner] && to.y == from.y + ALONG_Y[corner]) return BLOCK_LINK_CUT;
+    return BLOCK_LINK_NONE;
+}
+
+const char* LevelGenerator::styleName(LevelStyle style) {
+    static const char* names[LEVEL_STYLE_COUNT] = { "random", "maze", "rooms", "symmetric" };
+    return style >= 0 && style < LEVEL_STYLE_COUNT ? names[style] : "unknown";
+}
@@ -0,0 +1,88 @@
+#ifndef LEVELGENERATOR_H
+#define LEVELGENERATOR_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "Graph.h"
+#include "Snake.h"
+#include "Random.h"
+
+enum LevelStyle { LEVEL_RANDOM, LEVEL_MAZE, LEVEL_ROOMS, LEVEL_SYMMETRIC, LEVEL_STYLE_COUNT };
+
+// How one step of a body relates to the 2x2 blocks of a block cycle
+enum BlockLink { BLOCK_LINK_NONE, BLOCK_LINK_JOINED, BLOCK_LINK_CUT };
+
+struct LevelStats {
+    int placed = 0;
+    int rejected = 0;           // Walls skipped because they would seal off free cells
+    double millis = 0;
+};
+
+// Builds wall layouts whose free cells always form one 4-connected region.
+// Wall cells are tracked in a union-find of 8-connected wall components,
+// with the board edge as one extra node. A new wall that touches the same
+// component through two separate gaps around it would close a loop and cut
+// the free space in two, so it is rejected; any other wall is safe. Each
+// check looks only at the 8 neighbours, so a level costs O(walls placed).
+//
+// Maze and room styles draw lattice walls in random order and let the
+// rejected cells become the doorways.
+//
+// With cycle layouts on, the same styles are drawn on a board of 2x2 blocks
+// and every wall covers a whole block (an odd last row or column is walled),
+// so the free cells always have a Hamiltonian cycle over the free blocks.
+// Blocks that the body's own cycle cuts off from the head are walled as
+// well, which lets the next cycle keep the body where it lies.
+class LevelGenerator {
+private:
+    int width, height;
+    Random rng;
+    bool cycleLayouts;
+    std::vector<int> parent;        // Union-find over wall cells; index width*height is the edge
+    std::vector<uint8_t> rank;      // Union by rank keeps the trees shallow
+    std::vector<uint8_t> reserved;  // Cells that must stay open (the snake and its way ahead)
+    std::vector<int> reservedCells; // Set entries of reserved, cleared after each layout
+    // Cycle layouts: the block board and its generator, made on first use,
+    // and scratch for the blocks the body cuts off
+    std::unique_ptr<LevelGenerator> blocks;
+    std::unique_ptr<Graph> blockGraph;
+    std::vector<uint8_t> blockCuts;     // Bit 1: right side cut, bit 2: bottom side cut
+    std::vector<uint8_t> blockSeen;
+    std::vector<int> blockQueue;
+    LevelStats stats;
+
+    int borderNode() const { return width * height; }
+    int find(int node);
+    void unite(int a, int b);
+    bool tryPlace(Graph& graph, int x, int y);
+    void reserve(int x, int y);
+    void reserveSnake(const Snake& snake);
+    void placeScattered(Graph& graph, int level, bool mirrored);
+    void placeLattice(Graph& graph, int spacing, int extraDoorsPercent);
+    void placeBlocks(Graph& graph, int level, LevelStyle style, const Snake* snake);
+    void sealCutBlocks(Graph& graph, const Snake& snake);
+
+public:
+    LevelGenerator(int width, int height);
+    void seed(uint64_t value) { rng.seed(value); }
+    // Where the layout sequence stands; saved states resume it from here
+    uint64_t getRngState() const { return rng.getState(); }
+    void setRngState(uint64_t state) { rng.setState(state); }
+    // Wall whole 2x2 blocks only, for HamiltonianSolver
+    void setCycleLayouts(bool enabled) { cycleLayouts = enabled; }
+    bool getCycleLayouts() const { return cycleLayouts; }
+    // Replaces the graph's walls with a layout for `level`. Cells under the
+    // snake, and a few ahead of its head, are never walled.
+    void generate(Graph& graph, int level, LevelStyle style, const Snake* snake = nullptr);
+    const LevelStats& getStats() const { return stats; }
+    static const char* styleName(LevelStyle style);
+    // Block cycles run clockwise round each 2x2 block and are joined to
+    // neighbouring blocks across the sides of a spanning tree. A step from a
+    // cell either crosses the block side its corner faces (that side must be
+    // joined) or runs along the block (it must be cut); side is set to that
+    // side either way. BLOCK_LINK_NONE: no block cycle has this step.
+    static BlockLink classifyBlockLink(const SnakeSegment& from, const SnakeSegment& to, Direction& side);
+};
+
+#endif
@@ -0,0 +1,124 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : data(nullptr), size(0), writable(false) {
+#ifdef _WIN32
+    file = nullptr;
+    mapping = nullptr;
+#endif
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    return map(path, false, 0);
+}
+
+bool MappedFile::openWritable(const std::string& path, size_t fileSize) {
+    return fileSize > 0 && map(path, true, fileSize);
+}
+
+bool MappedFile::map(const std::string& path, bool write, size_t requiredSize) {
+    close();
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), write ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+                                FILE_SHARE_READ, nullptr, write ? OPEN_ALWAYS : OPEN_EXISTING,
+                                write ? FILE_ATTRIBUTE_NORMAL : FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER length;
+    if (write) {
+        length.QuadPart = static_cast<LONGLONG>(requiredSize);
+        if (!SetFilePointerEx(handle, length, nullptr, FILE_BEGIN) || !SetEndOfFile(handle)) {
+            CloseHandle(handle);
+            return false;
+        }
+    } else if (!GetFileSizeEx(handle, &length) || length.QuadPart == 0) {
+        CloseHandle(handle);
+        return false;
+    }
+    HANDLE view = CreateFileMappingA(handle, nullptr, write ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+    if (!view) {
+        CloseHandle(handle);
+        return false;
+    }
+    data = static_cast<uint8_t*>(MapViewOfFile(view, write ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+    if (!data) {
+        CloseHandle(view);
+        CloseHandle(handle);
+        return false;
+    }
+    file = handle;
+    mapping = view;
+    size = static_cast<size_t>(length.QuadPart);
+#else
+    int fd = ::open(path.c_str(), write ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    size_t length = static_cast<size_t>(info.st_size);
+    if (write && length != requiredSize) {
+        if (ftruncate(fd, static_cast<off_t>(requiredSize)) != 0) {
+            ::close(fd);
+            return false;
+        }
+        length = requiredSize;
+    }
+    if (length == 0) {
+        ::close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, length, write ? PROT_READ | PROT_WRITE : PROT_READ,
+                        write ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+    ::close(fd);    // The mapping keeps the file alive
+    if (mapped == MAP_FAILED) return false;
+    if (!write) {
+        // Read-only files are read front to back at startup: start now
+        madvise(mapped, length, MADV_WILLNEED);
+    }
+    data = static_cast<uint8_t*>(mapped);
+    size = length;
+#endif
+    writable = write;
+    return true;
+}
+
+void MappedFile::flush() {
+    if (!data || !writable) return;
+#ifdef _WIN32
+    FlushViewOfFile(data, 0);
+    FlushFileBuffers(file);
+#else
+    msync(data, size, MS_SYNC);
+#endif
+}
+
+void MappedFile::close() {
+    if (!data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mapping);
+    CloseHandle(file);
+    file = nullptr;
+    mapping = nullptr;
+#else
+    munmap(data, size);
+#endif
+    data = nullptr;
+    size = 0;
+    writable = false;
+}
@@ -0,0 +1,39 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// Memory mapping of a whole file: read-only, or read-write with a fixed size
+// (the file is created or resized to fit). Writes through a writable mapping
+// reach the file via the page cache; flush() forces them to disk.
+class MappedFile {
+private:
+    uint8_t* data;
+    size_t size;
+    bool writable;
+#ifdef _WIN32
+    void* file;
+    void* mapping;
+#endif
+
+    bool map(const std::string& path, bool write, size_t requiredSize);
+
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    bool openWritable(const std::string& path, size_t fileSize);
+    void flush();
+    void close();
+    bool isOpen() const { return data != nullptr; }
+    const uint8_t* getData() const { return data; }
+    uint8_t* getWritableData() { return writable ? data : nullptr; }
+    size_t getSize() const { return size; }
+};
+
+#endif
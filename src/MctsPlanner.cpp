@@ -0,0 +1,236 @@
+#include "MctsPlanner.h"
+#include <algorithm>
+#include <cmath>
+
+MctsPlanner::MctsPlanner(int width, int height, int maxFood, int threads, int maxNodes) :
+    width(width),
+    height(height),
+    capacity(maxNodes),
+    nodes(new Node[maxNodes]),
+    nodeCount(0),
+    pool(threads),
+    root(width, height, maxFood),
+    wallBits((static_cast<size_t>(width) * height + 63) / 64, 0),
+    wallRevision(~0ULL),
+    decisionCount(0),
+    totalMillis(0) {
+    for (int i = 0; i < pool.getThreadCount(); i++) {
+        workers.emplace_back(new Worker(width, height, maxFood));
+        workers.back()->rng.seed(0x3C75A11ULL + i);
+        workers.back()->path.reserve(MAX_TREE_DEPTH + 2);
+        workers.back()->rewards.reserve(MAX_TREE_DEPTH + 2);
+    }
+    stats.threads = pool.getThreadCount();
+}
+
+void MctsPlanner::resetStats() {
+    stats = MctsStats();
+    stats.threads = pool.getThreadCount();
+    totalMillis = 0;
+}
+
+int32_t MctsPlanner::newNode() {
+    int32_t index = nodeCount.fetch_add(1, std::memory_order_relaxed);
+    if (index >= capacity) return -1;
+    Node& node = nodes[index];
+    for (auto& child : node.children) child.store(-1, std::memory_order_relaxed);
+    node.visits.store(0, std::memory_order_relaxed);
+    node.virtualLoss.store(0, std::memory_order_relaxed);
+    node.valueSum.store(0, std::memory_order_relaxed);
+    return index;
+}
+
+void MctsPlanner::captureWalls(const Graph& graph) {
+    // Revision changes on every wall edit; the layout hash catches a
+    // different Graph that happens to be at the same revision
+    unsigned long long revision = graph.getRevision() ^ graph.getLayoutHash();
+    if (revision == wallRevision) return;
+    std::fill(wallBits.begin(), wallBits.end(), 0);
+    graph.forEachWall([this](int x, int y) {
+        int cell = y * width + x;
+        wallBits[cell >> 6] |= uint64_t(1) << (cell & 63);
+    });
+    wallRevision = revision;
+}
+
+int32_t MctsPlanner::select(int32_t index, const GameSnapshot& state, Direction& move) {
+    // Only moves that survive the next tick, unless there are none; a
+    // reversal is the same as going straight, so it is never a separate move
+    Direction reverse = static_cast<Direction>(state.getDirection() ^ 1);
+    bool anySafe = false;
+    for (int d = UP; d <= RIGHT; d++) {
+        if (d != reverse && state.isSafe(static_cast<Direction>(d))) anySafe = true;
+    }
+
+    Node& node = nodes[index];
+    double parentVisits = node.visits.load(std::memory_order_relaxed) + node.virtualLoss.load(std::memory_order_relaxed);
+    double logParent = std::log(std::max(1.0, parentVisits));
+    double bestScore = -1e30;
+    int32_t best = -1;
+    move = state.getDirection();
+    for (int d = UP; d <= RIGHT; d++) {
+        Direction dir = static_cast<Direction>(d);
+        if (dir == reverse || (anySafe && !state.isSafe(dir))) continue;
+        int32_t child = node.children[d].load(std::memory_order_acquire);
+        if (child < 0) {
+            // Untried moves go first
+            move = dir;
+            return -1;
+        }
+        Node& next = nodes[child];
+        double loss = next.virtualLoss.load(std::memory_order_relaxed);
+        double visits = next.visits.load(std::memory_order_relaxed) + loss;
+        if (visits <= 0) {
+            move = dir;
+            return child;
+        }
+        // Virtual loss counts as that many -1 returns
+        double mean = (static_cast<double>(next.valueSum.load(std::memory_order_relaxed)) / VALUE_SCALE - loss) / visits;
+        double score = mean + EXPLORATION * std::sqrt(logParent / visits);
+        if (score > bestScore) {
+            bestScore = score;
+            best = child;
+            move = dir;
+        }
+    }
+    return best;
+}
+
+float MctsPlanner::rollout(GameSnapshot& state, Random& rng) {
+    float total = 0;
+    float weight = 1;
+    const int stride = state.getWidth();
+    for (int t = 0; t < ROLLOUT_DEPTH && state.isAlive(); t++) {
+        // Safe moves; mostly the one closest to food, sometimes any
+        Direction reverse = static_cast<Direction>(state.getDirection() ^ 1);
+        Direction options[3];
+        int optionCount = 0;
+        Direction closest = state.getDirection();
+        int closestDistance = 1 << 30;
+        for (int d = UP; d <= RIGHT; d++) {
+            Direction dir = static_cast<Direction>(d);
+            if (dir == reverse || !state.isSafe(dir)) continue;
+            options[optionCount++] = dir;
+            int cell = state.target(dir);
+            for (int32_t item : state.getFood()) {
+                if (item < 0) continue;
+                int distance = std::abs(item % stride - cell % stride) + std::abs(item / stride - cell / stride);
+                if (distance < closestDistance) {
+                    closestDistance = distance;
+                    closest = dir;
+                }
+            }
+        }
+        Direction move = state.getDirection();
+        if (optionCount > 0) {
+            move = rng.nextBelow(4) != 0 ? closest : options[rng.nextBelow(optionCount)];
+        }
+
+        if (state.step(move)) total += weight;
+        if (!state.isAlive()) total -= weight;
+        weight *= DISCOUNT;
+    }
+    return total;
+}
+
+void MctsPlanner::update(int32_t index, float value) {
+    Node& node = nodes[index];
+    node.valueSum.fetch_add(static_cast<int64_t>(std::llround(value * VALUE_SCALE)), std::memory_order_relaxed);
+    node.visits.fetch_add(1, std::memory_order_relaxed);
+    node.virtualLoss.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void MctsPlanner::search(Worker& worker) {
+    GameSnapshot& state = worker.state;
+    std::vector<int32_t>& path = worker.path;
+    std::vector<float>& rewards = worker.rewards;
+
+    while (std::chrono::steady_clock::now() < deadline) {
+        state.copyFrom(root);
+        state.reseed(worker.rng.next());
+        path.clear();
+        rewards.clear();
+        path.push_back(0);
+        nodes[0].virtualLoss.fetch_add(1, std::memory_order_relaxed);
+
+        // Selection down to a missing child, which is expanded
+        int32_t index = 0;
+        while (state.isAlive() && static_cast<int>(path.size()) <= MAX_TREE_DEPTH) {
+            Direction move;
+            int32_t child = select(index, state, move);
+            bool ate = state.step(move);
+            rewards.push_back(ate ? 1.0f : (state.isAlive() ? 0.0f : -1.0f));
+            if (child < 0) {
+                child = newNode();
+                if (child >= 0) {
+                    int32_t expected = -1;
+                    if (!nodes[index].children[move].compare_exchange_strong(expected, child,
+                                                                             std::memory_order_acq_rel)) {
+                        child = expected;   // Another thread linked it first
+                    }
+                    path.push_back(child);
+                    nodes[child].virtualLoss.fetch_add(1, std::memory_order_relaxed);
+                }
+                break;
+            }
+            index = child;
+            path.push_back(child);
+            nodes[child].virtualLoss.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Back up discounted returns. rewards[i] is earned by the move from
+        // path[i] into path[i + 1], so each node's value includes the move
+        // that reached it; the last move has no node when the pool is full.
+        float value = state.isAlive() ? rollout(state, worker.rng) : 0.0f;
+        for (size_t i = rewards.size(); i-- > 0;) {
+            value = rewards[i] + DISCOUNT * value;
+            if (i + 1 < path.size()) update(path[i + 1], value);
+        }
+        update(path[0], value);
+        worker.rollouts++;
+    }
+}
+
+Direction MctsPlanner::decide(const Simulation& sim, double budgetMillis) {
+    auto started = std::chrono::steady_clock::now();
+    if (!sim.isAlive()) return sim.getSnake().getDirection();
+
+    captureWalls(sim.getGraph());
+    root.capture(sim, wallBits.data(), sim.getSeed() ^ (++decisionCount * 0x9E3779B97F4A7C15ULL));
+    nodeCount.store(0, std::memory_order_relaxed);
+    newNode();
+
+    unsigned long long rolloutsBefore = 0;
+    for (const auto& worker : workers) rolloutsBefore += worker->rollouts;
+    deadline = started + std::chrono::microseconds(static_cast<long long>(budgetMillis * 1000));
+    pool.parallelFor(pool.getThreadCount(), 1, [this](long long, int worker) { search(*workers[worker]); });
+
+    // Most visited move; with no finished iteration, any safe move
+    Direction reverse = static_cast<Direction>(root.getDirection() ^ 1);
+    Direction choice = root.getDirection();
+    int bestVisits = -1;
+    for (int d = UP; d <= RIGHT; d++) {
+        Direction dir = static_cast<Direction>(d);
+        if (dir == reverse) continue;
+        int32_t child = nodes[0].children[d].load(std::memory_order_relaxed);
+        int visits = child >= 0 ? nodes[child].visits.load(std::memory_order_relaxed) : (root.isSafe(dir) ? 0 : -1);
+        if (visits > bestVisits) {
+            bestVisits = visits;
+            choice = dir;
+        }
+    }
+
+    double millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    unsigned long long rollouts = 0;
+    for (const auto& worker : workers) rollouts += worker->rollouts;
+    stats.lastRollouts = rollouts - rolloutsBefore;
+    stats.rollouts += stats.lastRollouts;
+    stats.decisions++;
+    stats.lastMillis = millis;
+    totalMillis += millis;
+    stats.averageMillis = totalMillis / stats.decisions;
+    stats.maxMillis = std::max(stats.maxMillis, millis);
+    stats.rolloutsPerSecondPerThread = millis > 0 ? stats.lastRollouts / (millis / 1000.0) / pool.getThreadCount() : 0;
+    stats.lastTreeNodes = std::min(nodeCount.load(std::memory_order_relaxed), capacity);
+    return choice;
+}
@@ -0,0 +1,94 @@
+#ifndef MCTSPLANNER_H
+#define MCTSPLANNER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Simulation.h"
+#include "GameSnapshot.h"
+#include "WorkStealingPool.h"
+
+struct MctsStats {
+    double lastMillis = 0;              // Decision latency, capture to answer
+    double averageMillis = 0;
+    double maxMillis = 0;
+    unsigned long long lastRollouts = 0;
+    double rolloutsPerSecondPerThread = 0;  // Over the last decision
+    int lastTreeNodes = 0;
+    int threads = 0;
+    unsigned long long decisions = 0;
+    unsigned long long rollouts = 0;
+};
+
+// Monte Carlo tree search over the next moves, for a stronger AI than the
+// greedy autopilot. Each iteration clones the root GameSnapshot, walks the
+// tree by UCT, adds one node and finishes with a quick rollout (safe moves,
+// mostly toward the nearest food); food eaten scores +1 and death -1,
+// discounted per tick. The tree is open-loop: nodes are move sequences and
+// the food each iteration meets is sampled, since the player cannot know it.
+//
+// All pool threads search one shared tree until the time budget runs out.
+// Node statistics are atomics and children are linked in with a
+// compare-and-swap, so the tree takes no locks; a virtual loss on the path
+// being searched spreads threads over different branches. Nodes come from a
+// pool allocated once, so a decision does not allocate either.
+class MctsPlanner {
+private:
+    struct Node {
+        std::atomic<int32_t> children[4];   // By Direction; -1 until expanded
+        std::atomic<int32_t> visits;
+        std::atomic<int32_t> virtualLoss;   // Threads currently below this node
+        std::atomic<int64_t> valueSum;      // Returns, in VALUE_SCALE units
+    };
+    struct alignas(64) Worker {
+        GameSnapshot state;
+        Random rng;
+        std::vector<int32_t> path;
+        std::vector<float> rewards;
+        unsigned long long rollouts = 0;
+        Worker(int width, int height, int maxFood) : state(width, height, maxFood) {}
+    };
+
+    int width, height;
+    int capacity;
+    std::unique_ptr<Node[]> nodes;
+    std::atomic<int32_t> nodeCount;
+    WorkStealingPool pool;
+    std::vector<std::unique_ptr<Worker>> workers;
+    GameSnapshot root;
+    std::vector<uint64_t> wallBits;     // Snapshot walls, rebuilt when the Graph changes
+    unsigned long long wallRevision;
+    uint64_t decisionCount;
+    std::chrono::steady_clock::time_point deadline;
+    MctsStats stats;
+    double totalMillis;
+
+    static const int ROLLOUT_DEPTH = 40;
+    static const int MAX_TREE_DEPTH = 64;
+    static const int64_t VALUE_SCALE = 1 << 16;
+    static constexpr float DISCOUNT = 0.95f;
+    static constexpr double EXPLORATION = 1.0;
+
+    int32_t newNode();
+    int32_t select(int32_t node, const GameSnapshot& state, Direction& move);
+    float rollout(GameSnapshot& state, Random& rng);
+    void update(int32_t index, float value);
+    void search(Worker& worker);
+    void captureWalls(const Graph& graph);
+
+public:
+    // threads <= 0 uses every hardware thread; the caller of decide() is one
+    // of them
+    MctsPlanner(int width, int height, int maxFood = 3, int threads = 0, int maxNodes = 1 << 18);
+    MctsPlanner(const MctsPlanner&) = delete;
+    MctsPlanner& operator=(const MctsPlanner&) = delete;
+
+    // Searches for about budgetMillis and returns the most visited move
+    Direction decide(const Simulation& sim, double budgetMillis);
+    const MctsStats& getStats() const { return stats; }
+    void resetStats();
+};
+
+#endif
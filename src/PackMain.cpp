@@ -0,0 +1,38 @@
+#include "AssetPack.h"
+#include <iostream>
+#include <string>
+
+// Asset archive tool:
+//   snake_pack <asset directory> <output.pak>   pack every file under the directory
+//   snake_pack --list <file.pak>               print the archive index
+// The build runs the first form on assets/ when that directory exists.
+
+int main(int argc, char** argv) {
+    if (argc == 3 && std::string(argv[1]) == "--list") {
+        AssetPack pack;
+        if (!pack.open(argv[2])) {
+            std::cerr << argv[2] << ": not a valid asset pack" << std::endl;
+            return 1;
+        }
+        for (const auto& entry : pack.getEntries()) {
+            std::cout << entry.offset << "\t" << entry.size << "\t" << entry.name << std::endl;
+        }
+        return 0;
+    }
+
+    if (argc == 3) {
+        if (!AssetPack::build(argv[1], argv[2])) return 1;
+        AssetPack pack;
+        if (!pack.open(argv[2])) {
+            std::cerr << "Wrote an unreadable pack: " << argv[2] << std::endl;
+            return 1;
+        }
+        std::cout << argv[2] << ": " << pack.getEntries().size() << " assets" << std::endl;
+        return 0;
+    }
+
+    std::cout << "Usage:\n"
+              << "  snake_pack <asset directory> <output.pak>\n"
+              << "  snake_pack --list <file.pak>" << std::endl;
+    return 1;
+}
@@ -0,0 +1,12 @@
+#ifndef POSITION_H
+#define POSITION_H
+
+// Plain grid coordinate shared by the simulation core (no SFML types)
+struct Position {
+    int x, y;
+    Position(int x = 0, int y = 0) : x(x), y(y) {}
+    bool operator==(const Position& other) const { return x == other.x && y == other.y; }
+    bool operator!=(const Position& other) const { return !(*this == other); }
+};
+
+#endif
@@ -0,0 +1,77 @@
+#include "Profiler.h"
+#include <algorithm>
+
+namespace {
+const char* const PHASE_NAMES[PHASE_COUNT] = {
+    "frame", "events", "update", "graph_checks", "food_spawn",
+    "render", "draw_walls", "draw_snake", "draw_food", "hud", "present"
+};
+}
+
+Profiler::Profiler() : nextSlot(0), filled(0), frameNumber(0) {
+    std::fill(current, current + PHASE_COUNT, 0.0);
+    history.assign(static_cast<size_t>(PHASE_COUNT) * WINDOW, 0.0f);
+    scratch.resize(WINDOW);
+}
+
+void Profiler::endFrame() {
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        history[phase * WINDOW + nextSlot] = static_cast<float>(current[phase]);
+    }
+    nextSlot = (nextSlot + 1) % WINDOW;
+    if (filled < WINDOW) filled++;
+
+    if (csv.is_open()) {
+        csv << frameNumber;
+        for (int phase = 0; phase < PHASE_COUNT; phase++) {
+            csv << ',' << current[phase];
+        }
+        csv << '\n';
+    }
+
+    frameNumber++;
+    std::fill(current, current + PHASE_COUNT, 0.0);
+}
+
+PhaseSummary Profiler::summarize(ProfilePhase phase) {
+    PhaseSummary summary;
+    if (filled == 0) return summary;
+
+    const float* samples = &history[phase * WINDOW];
+    std::copy(samples, samples + filled, scratch.begin());
+
+    double total = 0;
+    float minimum = scratch[0];
+    for (int i = 0; i < filled; i++) {
+        total += scratch[i];
+        minimum = std::min(minimum, scratch[i]);
+    }
+    int p99Index = (filled * 99) / 100;
+    std::nth_element(scratch.begin(), scratch.begin() + p99Index, scratch.begin() + filled);
+
+    summary.minMicros = minimum;
+    summary.avgMicros = total / filled;
+    summary.p99Micros = scratch[p99Index];
+    return summary;
+}
+
+bool Profiler::startCsv(const std::string& path) {
+    stopCsv();
+    csv.open(path);
+    if (!csv.is_open()) return false;
+
+    csv << "frame";
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        csv << ',' << PHASE_NAMES[phase] << "_us";
+    }
+    csv << '\n';
+    return true;
+}
+
+void Profiler::stopCsv() {
+    if (csv.is_open()) csv.close();
+}
+
+const char* Profiler::phaseName(ProfilePhase phase) {
+    return PHASE_NAMES[phase];
+}
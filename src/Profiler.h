@@ -0,0 +1,77 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+enum ProfilePhase {
+    PHASE_FRAME,            // Whole loop iteration
+    PHASE_EVENTS,
+    PHASE_UPDATE,
+    PHASE_GRAPH_CHECKS,     // Boundary, wall and self-collision tests in a tick
+    PHASE_FOOD_SPAWN,
+    PHASE_RENDER,
+    PHASE_DRAW_WALLS,       // Static layer: background, grid, walls
+    PHASE_DRAW_SNAKE,
+    PHASE_DRAW_FOOD,
+    PHASE_HUD,
+    PHASE_PRESENT,
+    PHASE_COUNT
+};
+
+struct PhaseSummary {
+    double minMicros = 0;
+    double avgMicros = 0;
+    double p99Micros = 0;
+};
+
+// Per-frame phase timer. Scopes add elapsed time to the current frame;
+// endFrame() pushes the totals into a rolling window (for min/avg/p99) and,
+// while recording, appends them as one CSV row.
+class Profiler {
+private:
+    static const int WINDOW = 240;      // Frames kept per phase
+
+    double current[PHASE_COUNT];
+    std::vector<float> history;         // PHASE_COUNT rings of WINDOW samples
+    std::vector<float> scratch;         // Reused for percentile selection
+    int nextSlot;
+    int filled;
+    unsigned long long frameNumber;
+    std::ofstream csv;
+
+public:
+    Profiler();
+    void add(ProfilePhase phase, double micros) { current[phase] += micros; }
+    void endFrame();
+    PhaseSummary summarize(ProfilePhase phase);
+    bool startCsv(const std::string& path);
+    void stopCsv();
+    bool isRecording() const { return csv.is_open(); }
+    static const char* phaseName(ProfilePhase phase);
+};
+
+// Times its own lifetime into a phase; a null profiler makes it a no-op
+class ProfileScope {
+private:
+    Profiler* profiler;
+    ProfilePhase phase;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    ProfileScope(Profiler* profiler, ProfilePhase phase) : profiler(profiler), phase(phase) {
+        if (profiler) start = std::chrono::steady_clock::now();
+    }
+    ~ProfileScope() {
+        if (profiler) {
+            profiler->add(phase, std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - start).count());
+        }
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#endif
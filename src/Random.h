@@ -0,0 +1,41 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+// Small seedable PRNG (xorshift64*, seeded through splitmix64). Its output
+// depends only on the seed, not on the standard library, so a seeded game
+// replays identically on every platform.
+class Random {
+private:
+    uint64_t state;
+
+public:
+    explicit Random(uint64_t seedValue = 0) { seed(seedValue); }
+
+    void seed(uint64_t value) {
+        uint64_t z = value + 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        state = z ^ (z >> 31);
+        if (state == 0) state = 0x9E3779B97F4A7C15ULL;  // xorshift must not start at zero
+    }
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    }
+
+    // Uniform in [0, bound) by multiply-shift; bound must be positive
+    int nextBelow(int bound) {
+        return static_cast<int>(((next() >> 32) * static_cast<uint64_t>(bound)) >> 32);
+    }
+
+    uint64_t getState() const { return state; }
+    // Resume a sequence saved with getState()
+    void setState(uint64_t value) { state = value ? value : 0x9E3779B97F4A7C15ULL; }
+};
+
+#endif
@@ -0,0 +1,523 @@
+#include "Replay.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <memory>
+
+namespace {
+const uint8_t MAGIC[4] = {'S', 'N', 'K', 'R'};
+const uint8_t FORMAT_VERSION = 5;    // 2: level style; 3: final hash, food drawn in cell order; 4: cycle layouts; 5: keyframes
+const int UNDO_ACTION = 4;
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void putFixed64(std::vector<uint8_t>& out, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+}
+
+// Bounds-checked reader over an encoded replay
+class Reader {
+private:
+    const uint8_t* cursor;
+    const uint8_t* end;
+
+public:
+    Reader(const uint8_t* data, size_t size) : cursor(data), end(data + size) {}
+
+    bool varint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (cursor == end) return false;
+            uint8_t byte = *cursor++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    bool varint(int& value) {
+        uint64_t wide;
+        if (!varint(wide) || wide > 0x7FFFFFFF) return false;
+        value = static_cast<int>(wide);
+        return true;
+    }
+
+    bool fixed64(uint64_t& value) {
+        if (end - cursor < 8) return false;
+        value = 0;
+        for (int i = 0; i < 8; i++) {
+            value |= static_cast<uint64_t>(*cursor++) << (i * 8);
+        }
+        return true;
+    }
+
+    bool bytes(const uint8_t* expected, size_t count) {
+        if (static_cast<size_t>(end - cursor) < count || !std::equal(expected, expected + count, cursor)) {
+            return false;
+        }
+        cursor += count;
+        return true;
+    }
+
+    bool byte(uint8_t& value) {
+        if (cursor == end) return false;
+        value = *cursor++;
+        return true;
+    }
+
+    size_t remaining() const { return static_cast<size_t>(end - cursor); }
+};
+
+Direction stepBetween(const SnakeSegment& from, const SnakeSegment& to) {
+    if (to.x != from.x) return to.x > from.x ? RIGHT : LEFT;
+    return to.y > from.y ? DOWN : UP;
+}
+
+void putWalls(std::vector<uint8_t>& out, const SimulationState& state) {
+    // Sorted, so cells go out as small deltas
+    std::vector<int32_t> cells;
+    if (state.walls) cells = *state.walls;
+    std::sort(cells.begin(), cells.end());
+    putFixed64(out, state.layoutHash);
+    putVarint(out, cells.size());
+    int32_t previous = 0;
+    for (int32_t cell : cells) {
+        putVarint(out, cell - previous);
+        previous = cell;
+    }
+}
+
+void putKeyframe(std::vector<uint8_t>& out, const SimulationState& state, size_t layout, int width) {
+    putVarint(out, static_cast<uint64_t>(state.alive) | state.boardFull << 1 | state.growing << 2);
+    putVarint(out, state.deathCause);
+    putVarint(out, state.direction | state.nextDirection << 2);
+    putVarint(out, layout);
+
+    // The tail cell, then two bits per step towards the head (which may
+    // have left the board)
+    putVarint(out, state.body.size());
+    const SnakeSegment& tail = state.body.back();
+    putVarint(out, static_cast<uint64_t>(tail.y) * width + tail.x);
+    uint8_t packed = 0;
+    int bits = 0;
+    for (size_t i = state.body.size() - 1; i > 0; i--) {
+        packed |= stepBetween(state.body[i], state.body[i - 1]) << bits;
+        bits += 2;
+        if (bits == 8) {
+            out.push_back(packed);
+            packed = 0;
+            bits = 0;
+        }
+    }
+    if (bits > 0) out.push_back(packed);
+
+    putVarint(out, state.food.size());
+    for (const auto& position : state.food) {
+        putVarint(out, static_cast<uint64_t>(position.y) * width + position.x);
+    }
+    putFixed64(out, state.foodRngState);
+    putFixed64(out, state.layoutRngState);
+
+    ScoreProgress progress;
+    state.scores.saveProgress(progress);
+    putVarint(out, progress.score);
+    putVarint(out, progress.level);
+    putVarint(out, progress.undo.size());
+    for (const auto& entry : progress.undo) {
+        putVarint(out, entry.score);
+        putVarint(out, entry.level);
+    }
+    putVarint(out, progress.recent.size());
+    for (int points : progress.recent) {
+        putVarint(out, points);
+    }
+}
+
+bool readWalls(Reader& reader, uint64_t cells, uint64_t& layoutHash, std::vector<int32_t>& walls) {
+    uint64_t count;
+    if (!reader.fixed64(layoutHash) || !reader.varint(count) || count > reader.remaining()) return false;
+    walls.resize(count);
+    uint64_t cell = 0;
+    for (size_t i = 0; i < walls.size(); i++) {
+        uint64_t delta;
+        if (!reader.varint(delta) || (i > 0 && delta == 0) || delta >= cells - cell) return false;
+        cell += delta;
+        walls[i] = static_cast<int32_t>(cell);
+    }
+    return true;
+}
+
+bool readKeyframe(Reader& reader, SimulationState& state, const Replay& replay,
+                  const std::vector<SimulationState>& layouts) {
+    uint64_t cells = static_cast<uint64_t>(replay.width) * replay.height;
+    uint64_t flags, cause, directions, layout, length, tail;
+    if (!reader.varint(flags) || !reader.varint(cause) || !reader.varint(directions) || !reader.varint(layout)) {
+        return false;
+    }
+    if (flags > 7 || cause > DEATH_SELF || directions > 15 || layout >= layouts.size()) return false;
+    state.alive = flags & 1;
+    state.boardFull = (flags >> 1) & 1;
+    state.growing = (flags >> 2) & 1;
+    state.deathCause = static_cast<DeathCause>(cause);
+    state.direction = static_cast<Direction>(directions & 3);
+    state.nextDirection = static_cast<Direction>(directions >> 2);
+    state.walls = layouts[layout].walls;
+    state.layoutHash = layouts[layout].layoutHash;
+
+    // Four steps per byte bound the length
+    if (!reader.varint(length) || length == 0 || (length - 1) / 4 > reader.remaining()) return false;
+    if (!reader.varint(tail) || tail >= cells) return false;
+    state.body.resize(length);
+    SnakeSegment segment(static_cast<int>(tail % replay.width), static_cast<int>(tail / replay.width));
+    state.body[length - 1] = segment;
+    uint8_t packed = 0;
+    for (uint64_t i = 1; i < length; i++) {
+        if ((i - 1) % 4 == 0 && !reader.byte(packed)) return false;
+        switch (static_cast<Direction>((packed >> ((i - 1) % 4 * 2)) & 3)) {
+            case UP: segment.y--; break;
+            case DOWN: segment.y++; break;
+            case LEFT: segment.x--; break;
+            case RIGHT: segment.x++; break;
+        }
+        // Only the head may be off the board
+        bool inGrid = segment.x >= 0 && segment.x < replay.width && segment.y >= 0 && segment.y < replay.height;
+        if (!inGrid && i + 1 < length) return false;
+        state.body[length - 1 - i] = segment;
+    }
+
+    uint64_t foodCount;
+    if (!reader.varint(foodCount) || foodCount > reader.remaining()) return false;
+    state.food.resize(foodCount);
+    for (auto& position : state.food) {
+        uint64_t cell;
+        if (!reader.varint(cell) || cell >= cells) return false;
+        position = Position(static_cast<int>(cell % replay.width), static_cast<int>(cell / replay.width));
+    }
+    if (!reader.fixed64(state.foodRngState) || !reader.fixed64(state.layoutRngState)) return false;
+
+    ScoreProgress progress;
+    uint64_t undoCount, recentCount;
+    if (!reader.varint(progress.score) || !reader.varint(progress.level) ||
+        !reader.varint(undoCount) || undoCount > reader.remaining()) {
+        return false;
+    }
+    progress.undo.resize(undoCount);
+    for (auto& entry : progress.undo) {
+        if (!reader.varint(entry.score) || !reader.varint(entry.level)) return false;
+    }
+    if (!reader.varint(recentCount) || recentCount > reader.remaining()) return false;
+    progress.recent.resize(recentCount);
+    for (int& points : progress.recent) {
+        if (!reader.varint(points)) return false;
+    }
+    state.scores.restoreProgress(progress);
+    return true;
+}
+}
+
+void Replay::encode(std::vector<uint8_t>& out) const {
+    out.assign(MAGIC, MAGIC + 4);
+    out.push_back(FORMAT_VERSION);
+    putVarint(out, width);
+    putVarint(out, height);
+    putVarint(out, maxFood);
+    putVarint(out, keyframeInterval);
+    putVarint(out, levelStyle);
+    putVarint(out, cycleLayouts);
+    putFixed64(out, seed);
+    putVarint(out, totalTicks);
+
+    putVarint(out, events.size());
+    unsigned long long previous = 0;
+    for (const auto& event : events) {
+        uint64_t action = event.undo ? UNDO_ACTION : event.direction;
+        putVarint(out, ((event.tick - previous) << 3) | action);
+        previous = event.tick;
+    }
+
+    putVarint(out, checkpoints.size());
+    previous = 0;
+    for (const auto& checkpoint : checkpoints) {
+        putVarint(out, checkpoint.tick - previous);
+        putFixed64(out, checkpoint.stateHash);
+        previous = checkpoint.tick;
+    }
+
+    // Wall lists go out once, in level order; each keyframe names its list
+    std::vector<size_t> layoutOf(keyframes.size());
+    size_t layoutCount = 0;
+    for (size_t i = 0; i < keyframes.size(); i++) {
+        if (i == 0 || keyframes[i].walls != keyframes[i - 1].walls) layoutCount++;
+        layoutOf[i] = layoutCount - 1;
+    }
+    putVarint(out, layoutCount);
+    for (size_t i = 0; i < keyframes.size(); i++) {
+        if (i == 0 || layoutOf[i] != layoutOf[i - 1]) putWalls(out, keyframes[i]);
+    }
+    putVarint(out, keyframes.size());
+    for (size_t i = 0; i < keyframes.size(); i++) {
+        putKeyframe(out, keyframes[i], layoutOf[i], width);
+    }
+    putFixed64(out, finalHash);
+}
+
+bool Replay::decode(const uint8_t* data, size_t size) {
+    Reader reader(data, size);
+    uint8_t version;
+    if (!reader.bytes(MAGIC, 4) || !reader.byte(version) || version != FORMAT_VERSION) return false;
+
+    Replay parsed;
+    uint64_t ticks, eventCount, checkpointCount;
+    int style, cycleLayouts;
+    if (!reader.varint(parsed.width) || !reader.varint(parsed.height) || !reader.varint(parsed.maxFood) ||
+        !reader.varint(parsed.keyframeInterval) || !reader.varint(style) || !reader.varint(cycleLayouts) ||
+        !reader.fixed64(parsed.seed) || !reader.varint(ticks)) {
+        return false;
+    }
+    if (parsed.width <= 0 || parsed.height <= 0 || parsed.keyframeInterval <= 0) return false;
+    if (style < 0 || style >= LEVEL_STYLE_COUNT || cycleLayouts > 1) return false;
+    parsed.levelStyle = static_cast<LevelStyle>(style);
+    parsed.cycleLayouts = cycleLayouts != 0;
+    parsed.totalTicks = ticks;
+
+    // Every record takes at least one byte, which bounds the counts
+    if (!reader.varint(eventCount) || eventCount > size) return false;
+    parsed.events.resize(eventCount);
+    unsigned long long tick = 0;
+    for (auto& event : parsed.events) {
+        uint64_t record;
+        if (!reader.varint(record)) return false;
+        int action = static_cast<int>(record & 7);
+        if (action > UNDO_ACTION) return false;
+        tick += record >> 3;
+        event.tick = tick;
+        event.undo = action == UNDO_ACTION;
+        event.direction = event.undo ? RIGHT : static_cast<Direction>(action);
+    }
+
+    if (!reader.varint(checkpointCount) || checkpointCount > size) return false;
+    parsed.checkpoints.resize(checkpointCount);
+    tick = 0;
+    for (auto& checkpoint : parsed.checkpoints) {
+        uint64_t delta;
+        if (!reader.varint(delta) || !reader.fixed64(checkpoint.stateHash)) return false;
+        tick += delta;
+        checkpoint.tick = tick;
+    }
+
+    // Layouts are held as states carrying just the shared wall list
+    uint64_t layoutCount, keyframeCount;
+    if (!reader.varint(layoutCount) || layoutCount > size) return false;
+    std::vector<SimulationState> layouts(layoutCount);
+    uint64_t cells = static_cast<uint64_t>(parsed.width) * parsed.height;
+    for (auto& layout : layouts) {
+        auto walls = std::make_shared<std::vector<int32_t>>();
+        if (!readWalls(reader, cells, layout.layoutHash, *walls)) return false;
+        layout.walls = walls;
+    }
+    // One keyframe per interval, starting at tick 0
+    if (!reader.varint(keyframeCount) || keyframeCount != parsed.totalTicks / parsed.keyframeInterval + 1 ||
+        keyframeCount > size) {
+        return false;
+    }
+    parsed.keyframes.resize(keyframeCount);
+    for (size_t i = 0; i < parsed.keyframes.size(); i++) {
+        SimulationState& state = parsed.keyframes[i];
+        state.seed = parsed.seed;
+        state.tickCount = i * static_cast<unsigned long long>(parsed.keyframeInterval);
+        if (!readKeyframe(reader, state, parsed, layouts)) return false;
+    }
+    if (!reader.fixed64(parsed.finalHash)) return false;
+
+    *this = std::move(parsed);
+    return true;
+}
+
+bool Replay::save(const std::string& path) const {
+    std::vector<uint8_t> bytes;
+    encode(bytes);
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return static_cast<bool>(file);
+}
+
+bool Replay::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return decode(bytes.data(), bytes.size());
+}
+
+ReplayRecorder::ReplayRecorder(int keyframeInterval) : lastDirection(RIGHT), recording(false) {
+    replay.keyframeInterval = keyframeInterval;
+}
+
+void ReplayRecorder::begin(const Simulation& simulation) {
+    int interval = replay.keyframeInterval;
+    replay = Replay();
+    replay.keyframeInterval = interval;
+    replay.width = simulation.getWidth();
+    replay.height = simulation.getHeight();
+    replay.maxFood = simulation.getFood().getMaxCount();
+    replay.seed = simulation.getSeed();
+    replay.levelStyle = simulation.getLevelStyle();
+    replay.cycleLayouts = simulation.getCycleLayouts();
+    lastDirection = simulation.getSnake().getDirection();
+    recording = true;
+    addKeyframe(simulation);
+}
+
+void ReplayRecorder::addKeyframe(const Simulation& simulation) {
+    SimulationState state;
+    if (!replay.keyframes.empty()) {
+        // Lets saveState() reuse the wall list while the level is unchanged
+        state.walls = replay.keyframes.back().walls;
+        state.layoutHash = replay.keyframes.back().layoutHash;
+    }
+    simulation.saveState(state);
+    replay.keyframes.push_back(std::move(state));
+}
+
+void ReplayRecorder::recordTick(const Simulation& simulation) {
+    if (!recording) return;
+
+    // The heading the snake actually moved with; logged only when it changes
+    unsigned long long tick = simulation.getTickCount();
+    Direction moved = simulation.getSnake().getDirection();
+    if (moved != lastDirection) {
+        ReplayEvent event;
+        event.tick = tick - 1;
+        event.direction = moved;
+        replay.events.push_back(event);
+        lastDirection = moved;
+    }
+
+    if (tick % replay.keyframeInterval == 0) {
+        ReplayCheckpoint checkpoint;
+        checkpoint.tick = tick;
+        checkpoint.stateHash = simulation.getStateHash();
+        replay.checkpoints.push_back(checkpoint);
+        addKeyframe(simulation);
+    }
+    replay.totalTicks = tick;
+}
+
+void ReplayRecorder::recordUndo(const Simulation& simulation) {
+    if (!recording) return;
+
+    ReplayEvent event;
+    event.tick = simulation.getTickCount();
+    event.undo = true;
+    replay.events.push_back(event);
+}
+
+void ReplayRecorder::finish(const Simulation& simulation) {
+    if (!recording) return;
+    replay.totalTicks = simulation.getTickCount();
+    replay.finalHash = simulation.getStateHash();
+    recording = false;
+}
+
+ReplayPlayer::ReplayPlayer(const Replay& replay) :
+    replay(replay),
+    simulation(replay.width, replay.height, replay.maxFood),
+    nextEvent(0),
+    nextCheckpoint(0),
+    divergedAt(-1) {
+    restart();
+}
+
+void ReplayPlayer::restart() {
+    simulation.setLevelStyle(replay.levelStyle);
+    simulation.setCycleLayouts(replay.cycleLayouts);
+    simulation.reset(replay.seed);
+    nextEvent = 0;
+    nextCheckpoint = 0;
+    divergedAt = -1;
+}
+
+void ReplayPlayer::applyEvents() {
+    unsigned long long tick = simulation.getTickCount();
+    while (nextEvent < replay.events.size() && replay.events[nextEvent].tick <= tick) {
+        const ReplayEvent& event = replay.events[nextEvent++];
+        if (event.tick < tick) continue;
+        if (event.undo) {
+            simulation.getScoreManager().undoLastScore();
+        } else {
+            simulation.setDirection(event.direction);
+        }
+    }
+}
+
+bool ReplayPlayer::step() {
+    if (isFinished()) return false;
+
+    applyEvents();
+    simulation.step();
+
+    unsigned long long tick = simulation.getTickCount();
+    if (nextCheckpoint < replay.checkpoints.size() && replay.checkpoints[nextCheckpoint].tick == tick) {
+        if (divergedAt < 0 && replay.checkpoints[nextCheckpoint].stateHash != simulation.getStateHash()) {
+            divergedAt = static_cast<long long>(tick);
+        }
+        nextCheckpoint++;
+    }
+    if (tick == replay.totalTicks && divergedAt < 0 && replay.finalHash != simulation.getStateHash()) {
+        divergedAt = static_cast<long long>(tick);
+    }
+    if (!simulation.isAlive() && tick < replay.totalTicks && divergedAt < 0) {
+        divergedAt = static_cast<long long>(tick);   // Died before the recorded end
+    }
+    return true;
+}
+
+unsigned long long ReplayPlayer::run() {
+    unsigned long long executed = 0;
+    while (step()) {
+        executed++;
+    }
+    return executed;
+}
+
+void ReplayPlayer::restore(size_t keyframe) {
+    simulation.restoreState(replay.keyframes[keyframe]);
+
+    // A keyframe is taken before that tick's inputs are applied
+    unsigned long long tick = simulation.getTickCount();
+    nextEvent = std::lower_bound(replay.events.begin(), replay.events.end(), tick,
+        [](const ReplayEvent& event, unsigned long long value) { return event.tick < value; })
+        - replay.events.begin();
+    nextCheckpoint = std::upper_bound(replay.checkpoints.begin(), replay.checkpoints.end(), tick,
+        [](unsigned long long value, const ReplayCheckpoint& checkpoint) { return value < checkpoint.tick; })
+        - replay.checkpoints.begin();
+}
+
+void ReplayPlayer::seek(unsigned long long tick) {
+    tick = std::min(tick, replay.totalTicks);
+    unsigned long long current = simulation.getTickCount();
+    if (!replay.keyframes.empty()) {
+        size_t keyframe = std::min<size_t>(tick / replay.keyframeInterval, replay.keyframes.size() - 1);
+
+        // Step on from here when that is no further than from the nearest keyframe
+        if (current > tick || current < replay.keyframes[keyframe].tickCount) {
+            restore(keyframe);
+        }
+    } else if (current > tick) {
+        restart();
+    }
+    while (simulation.getTickCount() < tick && step()) {
+    }
+}
+
+bool ReplayPlayer::isFinished() const {
+    return !simulation.isAlive() || simulation.getTickCount() >= replay.totalTicks;
+}
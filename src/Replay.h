@@ -0,0 +1,98 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "Simulation.h"
+
+// One input, applied before the tick that starts with `tick` ticks done
+struct ReplayEvent {
+    unsigned long long tick = 0;
+    bool undo = false;          // Score undo instead of a turn
+    Direction direction = RIGHT;
+};
+
+struct ReplayCheckpoint {
+    unsigned long long tick = 0;
+    uint64_t stateHash = 0;     // Simulation::getStateHash() after that tick
+};
+
+// A recorded game: the seed plus every heading change and score undo. On
+// disk, events are varints of (tick delta << 3 | action), so a turn costs one
+// or two bytes. A state hash every keyframeInterval ticks, and one of the
+// final state, let playback detect (and bracket) any divergence from the
+// original game, however short. A compact SimulationState is stored at the
+// same ticks so playback can start anywhere; keyframes on one level share
+// its wall list, which the file holds once.
+struct Replay {
+    int width = 0;
+    int height = 0;
+    int maxFood = 0;
+    int keyframeInterval = 256;
+    LevelStyle levelStyle = LEVEL_RANDOM;
+    bool cycleLayouts = false;  // Simulation::setCycleLayouts()
+    uint64_t seed = 0;
+    unsigned long long totalTicks = 0;
+    std::vector<ReplayEvent> events;
+    std::vector<ReplayCheckpoint> checkpoints;
+    std::vector<SimulationState> keyframes;     // keyframes[i] holds tick i * keyframeInterval
+    uint64_t finalHash = 0;     // Simulation::getStateHash() at totalTicks
+
+    void encode(std::vector<uint8_t>& out) const;
+    bool decode(const uint8_t* data, size_t size);
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+};
+
+// Captures a game as it is played. Call begin() after Simulation::reset(),
+// recordTick() after every step and recordUndo() whenever a score is undone.
+class ReplayRecorder {
+private:
+    Replay replay;
+    Direction lastDirection;
+    bool recording;
+
+    void addKeyframe(const Simulation& simulation);
+
+public:
+    explicit ReplayRecorder(int keyframeInterval = 256);
+    void begin(const Simulation& simulation);
+    void recordTick(const Simulation& simulation);
+    void recordUndo(const Simulation& simulation);
+    void finish(const Simulation& simulation);
+    bool isRecording() const { return recording; }
+    const Replay& getReplay() const { return replay; }
+};
+
+// Re-runs a replay headless. seek() restores the replay's nearest keyframe
+// at or before the target, so it costs one restore plus at most one interval
+// of stepping, even on a fresh player.
+class ReplayPlayer {
+private:
+    const Replay& replay;
+    Simulation simulation;
+    size_t nextEvent;
+    size_t nextCheckpoint;
+    long long divergedAt;
+
+    void applyEvents();
+    void restore(size_t keyframe);
+
+public:
+    explicit ReplayPlayer(const Replay& replay);
+    void restart();
+    // Plays one tick; false once the replay has ended
+    bool step();
+    // Plays at full speed to the end; returns the ticks executed
+    unsigned long long run();
+    void seek(unsigned long long tick);
+    bool isFinished() const;
+    // First checkpoint tick whose state hash did not match (or the tick of a
+    // death before the recorded end), or -1
+    long long getDivergenceTick() const { return divergedAt; }
+    const Simulation& getSimulation() const { return simulation; }
+};
+
+#endif
@@ -0,0 +1,143 @@
+#include "Replay.h"
+#include "Autopilot.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Headless replay tool:
+//   snake_replay record <file> [seed] [width height] [--style name]
+//                                                      record a greedy-autopilot game
+//   snake_replay play <file>... [--seek tick]          replay and verify at full speed
+// "play" exits non-zero if any replay diverges from its recorded checkpoints.
+
+namespace {
+bool parseStyle(const std::string& name, LevelStyle& style) {
+    for (int i = 0; i < LEVEL_STYLE_COUNT; i++) {
+        if (name == LevelGenerator::styleName(static_cast<LevelStyle>(i))) {
+            style = static_cast<LevelStyle>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+int record(const std::string& path, uint64_t seed, int width, int height, LevelStyle style) {
+    Simulation simulation(width, height, 3);
+    Autopilot autopilot(width, height);
+    ReplayRecorder recorder;
+
+    simulation.setLevelStyle(style);
+    simulation.reset(seed);
+    recorder.begin(simulation);
+    while (simulation.isAlive() && simulation.getTickCount() < 1000000) {
+        simulation.step(autopilot.decide(simulation));
+        recorder.recordTick(simulation);
+    }
+    recorder.finish(simulation);
+
+    if (!recorder.getReplay().save(path)) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return 1;
+    }
+    std::cout << path << ": seed " << seed << ", " << LevelGenerator::styleName(style) << " levels, " << simulation.getTickCount() << " ticks, score "
+              << simulation.getScoreManager().getCurrentScore() << ", "
+              << recorder.getReplay().events.size() << " events, "
+              << recorder.getReplay().keyframes.size() << " keyframes" << std::endl;
+    return 0;
+}
+
+bool play(const std::string& path, long long seekTick) {
+    Replay replay;
+    if (!replay.load(path)) {
+        std::cerr << path << ": not a valid replay" << std::endl;
+        return false;
+    }
+
+    ReplayPlayer player(replay);
+    auto start = std::chrono::steady_clock::now();
+    unsigned long long ticks = player.run();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const Simulation& result = player.getSimulation();
+    std::cout << path << ": " << ticks << " ticks in " << seconds * 1000.0 << " ms ("
+              << (seconds > 0 ? ticks / seconds : 0.0) << " ticks/s), score "
+              << result.getScoreManager().getCurrentScore() << ", level "
+              << result.getScoreManager().getCurrentLevel();
+
+    bool ok = player.getDivergenceTick() < 0 && ticks == replay.totalTicks;
+    if (player.getDivergenceTick() >= 0) {
+        std::cout << ", DIVERGED by tick " << player.getDivergenceTick();
+    } else if (ticks != replay.totalTicks) {
+        std::cout << ", ENDED EARLY (recorded " << replay.totalTicks << ")";
+    } else {
+        std::cout << ", verified " << replay.checkpoints.size() << " checkpoints and the final state";
+    }
+    std::cout << std::endl;
+
+    if (seekTick >= 0) {
+        // A fresh player, so the seek starts from a stored keyframe
+        ReplayPlayer seeker(replay);
+        auto seekStart = std::chrono::steady_clock::now();
+        seeker.seek(static_cast<unsigned long long>(seekTick));
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - seekStart).count();
+        std::cout << "  seek to " << seeker.getSimulation().getTickCount() << ": " << micros
+                  << " us, state hash " << std::hex << seeker.getSimulation().getStateHash() << std::dec << std::endl;
+    }
+    return ok;
+}
+}
+
+int main(int argc, char** argv) {
+    std::string mode = argc > 1 ? argv[1] : "";
+
+    if (mode == "record" && argc >= 3) {
+        LevelStyle style = LEVEL_RANDOM;
+        std::vector<std::string> positional;
+        for (int i = 2; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--style" && i + 1 < argc) {
+                if (!parseStyle(argv[++i], style)) {
+                    std::cerr << "Unknown level style " << argv[i] << std::endl;
+                    return 1;
+                }
+            } else {
+                positional.push_back(arg);
+            }
+        }
+        uint64_t seed = positional.size() >= 2 ? std::strtoull(positional[1].c_str(), nullptr, 10) : 1;
+        int width = positional.size() >= 4 ? std::atoi(positional[2].c_str()) : 30;
+        int height = positional.size() >= 4 ? std::atoi(positional[3].c_str()) : 20;
+        if (width < 8 || height < 8) {
+            std::cerr << "Grid must be at least 8x8" << std::endl;
+            return 1;
+        }
+        return record(positional[0], seed, width, height, style);
+    }
+
+    if (mode == "play" && argc >= 3) {
+        long long seekTick = -1;
+        bool allOk = true;
+        for (int i = 2; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--seek" && i + 1 < argc) {
+                seekTick = std::atoll(argv[++i]);
+            }
+        }
+        for (int i = 2; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--seek") {
+                i++;
+                continue;
+            }
+            allOk = play(arg, seekTick) && allOk;
+        }
+        return allOk ? 0 : 2;
+    }
+
+    std::cout << "Usage:\n"
+              << "  snake_replay record <file> [seed] [width height] [--style random|maze|rooms|symmetric]\n"
+              << "  snake_replay play <file>... [--seek tick]" << std::endl;
+    return 1;
+}
@@ -4,16 +4,30 @@
 #include <sstream>
 #include <iomanip>
  
-ScoreManager::ScoreManager() : currentScore(0), currentLevel(1) {}
+ScoreManager::ScoreManager() :
+    undoNewest(0),
+    undoCount(0),
+    recentFirst(0),
+    recentCount(0),
+    currentScore(0),
+    currentLevel(1),
+    highScoreRevision(0) {
+    // gameOver() inserts before trimming, so the table never grows past this
+    highScores.reserve(MAX_HIGH_SCORES + 1);
+}
 
 void ScoreManager::addScore(int points) {
-    scoreHistory.push(ScoreEntry(currentScore, currentLevel, getCurrentTimestamp()));
+    undoNewest = (undoNewest + 1) % UNDO_CAPACITY;
+    undoHistory[undoNewest] = UndoEntry{ currentScore, currentLevel };
+    if (undoCount < UNDO_CAPACITY) undoCount++;
     currentScore += points;
-    
-    // Add to recent scores queue
-    recentScores.push(points);
-    if (recentScores.size() > MAX_RECENT_SCORES) {
-        recentScores.pop();
+
+    if (recentCount < MAX_RECENT_SCORES) {
+        recentScores[(recentFirst + recentCount) % MAX_RECENT_SCORES] = points;
+        recentCount++;
+    } else {
+        recentScores[recentFirst] = points;
+        recentFirst = (recentFirst + 1) % MAX_RECENT_SCORES;
     }
 }
 
@@ -22,67 +36,77 @@ void ScoreManager::setLevel(int level) {
 }
 
 void ScoreManager::gameOver() {
-    // Add final score to high scores
-    ScoreEntry finalScore(currentScore, currentLevel, getCurrentTimestamp());
-    highScores.push_back(finalScore);
-    
-    // Sort high scores in descending order
-    std::sort(highScores.begin(), highScores.end(),
-              [](const ScoreEntry& a, const ScoreEntry& b) {
-                  return a.score > b.score;
-              });
-    
-    // Keep only top scores
+    // The table is kept sorted (descending), so a new score is inserted in
+    // place; equal scores keep the earlier game first
+    auto position = std::upper_bound(highScores.begin(), highScores.end(), currentScore,
+                                     [](int score, const ScoreEntry& entry) { return score > entry.score; });
+    if (position - highScores.begin() >= MAX_HIGH_SCORES) return;
+    highScores.insert(position, ScoreEntry(currentScore, currentLevel, static_cast<int64_t>(std::time(nullptr))));
     if (highScores.size() > MAX_HIGH_SCORES) {
-        highScores.resize(MAX_HIGH_SCORES);
+        highScores.pop_back();
     }
+    highScoreRevision++;
 }
 
 void ScoreManager::reset() {
     currentScore = 0;
     currentLevel = 1;
-    
-    // Clear score history and recent scores
-    while (!scoreHistory.empty()) scoreHistory.pop();
-    while (!recentScores.empty()) recentScores.pop();
-}
-
-std::vector<int> ScoreManager::getRecentScores() const {
-    std::vector<int> recent;
-    std::queue<int> temp = recentScores;
-    
-    while (!temp.empty()) {
-        recent.push_back(temp.front());
-        temp.pop();
-    }
-    
-    return recent;
+    undoCount = 0;
+    recentCount = 0;
+    recentFirst = 0;
 }
 
 bool ScoreManager::canUndo() const {
-    return !scoreHistory.empty();
+    return undoCount > 0;
 }
 
 void ScoreManager::undoLastScore() {
-    if (!scoreHistory.empty()) {
-        ScoreEntry lastEntry = scoreHistory.top();
-        scoreHistory.pop();
-        currentScore = lastEntry.score;
-        currentLevel = lastEntry.level;
-        
-        // Remove from recent scores (simplified - just pop the last one)
-        if (!recentScores.empty()) {
-            // This is a simplified undo - in a real implementation,
-            // you might want to track what was undone more carefully
-        }
+    if (undoCount == 0) return;
+    const UndoEntry& last = undoHistory[undoNewest];
+    currentScore = last.score;
+    currentLevel = last.level;
+    undoNewest = (undoNewest + UNDO_CAPACITY - 1) % UNDO_CAPACITY;
+    undoCount--;
+
+    // The undone addition is the newest recent one
+    if (recentCount > 0) recentCount--;
+}
+
+void ScoreManager::saveProgress(ScoreProgress& progress) const {
+    progress.score = currentScore;
+    progress.level = currentLevel;
+    progress.undo.clear();
+    for (int i = undoCount - 1; i >= 0; i--) {
+        const UndoEntry& entry = undoHistory[(undoNewest + UNDO_CAPACITY - i) % UNDO_CAPACITY];
+        progress.undo.push_back(ScoreEntry(entry.score, entry.level, 0));
+    }
+    progress.recent.clear();
+    for (int i = 0; i < recentCount; i++) {
+        progress.recent.push_back(recentScores[(recentFirst + i) % MAX_RECENT_SCORES]);
     }
 }
 
-std::string ScoreManager::getCurrentTimestamp() const {
-    auto now = std::time(nullptr);
-    auto tm = *std::localtime(&now);
-    
+void ScoreManager::restoreProgress(const ScoreProgress& progress) {
+    reset();
+    currentScore = progress.score;
+    currentLevel = progress.level;
+    // Only the newest entries fit in the rings
+    size_t firstUndo = progress.undo.size() > UNDO_CAPACITY ? progress.undo.size() - UNDO_CAPACITY : 0;
+    for (size_t i = firstUndo; i < progress.undo.size(); i++) {
+        undoNewest = (undoNewest + 1) % UNDO_CAPACITY;
+        undoHistory[undoNewest] = UndoEntry{ progress.undo[i].score, progress.undo[i].level };
+        undoCount++;
+    }
+    size_t firstRecent = progress.recent.size() > MAX_RECENT_SCORES ? progress.recent.size() - MAX_RECENT_SCORES : 0;
+    for (size_t i = firstRecent; i < progress.recent.size(); i++) {
+        recentScores[recentCount++] = progress.recent[i];
+    }
+}
+
+std::string ScoreManager::formatTimestamp(int64_t time) {
+    std::time_t seconds = static_cast<std::time_t>(time);
+    std::tm local = *std::localtime(&seconds);
     std::stringstream ss;
-    ss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
+    ss << std::put_time(&local, "%Y-%m-%d %H:%M");
     return ss.str();
-}
\ No newline at end of file
+}
@@ -1,29 +1,67 @@
 #ifndef SCOREMANAGER_H
 #define SCOREMANAGER_H
 
-#include <stack>
-#include <queue>
+#include <cstdint>
 #include <vector>
 #include <string>
 
 struct ScoreEntry {
     int score = 0;
     int level = 0;
-    std::string timestamp;
+    int64_t time = 0;           // Unix seconds; formatted only for display
 
     ScoreEntry() = default;
-    ScoreEntry(int s, int l, const std::string& t) : score(s), level(l), timestamp(t) {}
+    ScoreEntry(int s, int l, int64_t t) : score(s), level(l), time(t) {}
 };
 
+// One game's scoring without the session's high-score table, for saving a
+// game in progress
+struct ScoreProgress {
+    int score = 0;
+    int level = 1;
+    std::vector<ScoreEntry> undo;   // Score and level before each undoable addition, oldest first (time unused)
+    std::vector<int> recent;        // Latest additions, oldest first
+};
+
+// Non-owning view of the recent score additions, oldest first. Valid until
+// the next change to the ScoreManager it came from.
+class RecentScoresView {
+private:
+    const int* ring;
+    int capacity;
+    int first;
+    int count;
+
+public:
+    RecentScoresView(const int* r, int c, int f, int n) : ring(r), capacity(c), first(f), count(n) {}
+    int operator[](int i) const { return ring[(first + i) % capacity]; }
+    int size() const { return count; }
+};
+
+// Scoring runs every tick, so its state is fixed-size: the undo history and
+// the recent additions are ring buffers (the oldest entry is dropped when
+// full), and no timestamp is taken or formatted until a game ends.
 class ScoreManager {
 private:
-    std::stack<ScoreEntry> scoreHistory;    // For undo functionality
-    std::queue<int> recentScores;          // For recent scores tracking
-    std::vector<ScoreEntry> highScores;    // For persistent high scores
-    int currentScore;
-    int currentLevel;
+    struct UndoEntry {
+        int score;
+        int level;
+    };
+
     static const int MAX_HIGH_SCORES = 10;
     static const int MAX_RECENT_SCORES = 5;
+    static const int UNDO_CAPACITY = 64;
+
+    UndoEntry undoHistory[UNDO_CAPACITY];   // Ring: the last UNDO_CAPACITY scores can be undone
+    int undoNewest;
+    int undoCount;
+    int recentScores[MAX_RECENT_SCORES];    // Ring of the latest additions
+    int recentFirst;
+    int recentCount;
+    std::vector<ScoreEntry> highScores;     // Best scores this session, sorted descending
+    int currentScore;
+    int currentLevel;
+    unsigned long long highScoreRevision;   // Bumped whenever highScores changes
 
 public:
     ScoreManager();
@@ -33,11 +71,18 @@ public:
     void reset();
     int getCurrentScore() const { return currentScore; }
     int getCurrentLevel() const { return currentLevel; }
-    std::vector<ScoreEntry> getHighScores() const { return highScores; }
-    std::vector<int> getRecentScores() const;
+    const std::vector<ScoreEntry>& getHighScores() const { return highScores; }
+    unsigned long long getHighScoreRevision() const { return highScoreRevision; }
+    RecentScoresView getRecentScores() const {
+        return RecentScoresView(recentScores, MAX_RECENT_SCORES, recentFirst, recentCount);
+    }
     bool canUndo() const;
     void undoLastScore();
-    std::string getCurrentTimestamp() const;
+    void saveProgress(ScoreProgress& progress) const;
+    // Replaces the current game's scoring; high scores are kept
+    void restoreProgress(const ScoreProgress& progress);
+    // Local time as "YYYY-MM-DD HH:MM"
+    static std::string formatTimestamp(int64_t time);
 };
 
-#endif
\ No newline at end of file
+#endif
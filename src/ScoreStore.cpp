@@ -0,0 +1,234 @@
+#include "ScoreStore.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+
+namespace {
+const char LOG_MAGIC[4] = {'S', 'N', 'K', 'S'};
+const char INDEX_MAGIC[4] = {'S', 'N', 'K', 'T'};
+const uint32_t FORMAT_VERSION = 1;
+const uint64_t INDEX_DIRTY = ~0ULL;     // logRecords while the heap is being changed
+
+struct LogHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(ScoreRecord) == 32, "ScoreRecord is an on-disk format");
+static_assert(sizeof(LogHeader) == 16, "LogHeader is an on-disk format");
+
+// Heap order: the worst kept record sits at the root
+bool better(const ScoreRecord& a, const ScoreRecord& b) {
+    if (a.score != b.score) return a.score > b.score;
+    return a.time < b.time;
+}
+}
+
+struct ScoreStore::IndexHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t count;
+    uint64_t logRecords;        // Log records included, or INDEX_DIRTY
+    uint64_t reserved;
+};
+
+ScoreStore::ScoreStore(int capacity) :
+    log(nullptr),
+    capacity(capacity),
+    logRecords(0),
+    revision(0),
+    sortedRevision(~0ULL) {}
+
+ScoreStore::~ScoreStore() {
+    close();
+}
+
+ScoreStore::IndexHeader* ScoreStore::header() {
+    return reinterpret_cast<IndexHeader*>(index.getWritableData());
+}
+
+ScoreRecord* ScoreStore::heap() {
+    return reinterpret_cast<ScoreRecord*>(index.getWritableData() + sizeof(IndexHeader));
+}
+
+uint32_t ScoreStore::checksum(const ScoreRecord& record) {
+    // FNV-1a over everything before the checksum field
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&record);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(ScoreRecord, checksum); i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash == 0 ? 1 : hash;
+}
+
+bool ScoreStore::open(const std::string& logPath, const std::string& indexPath) {
+    namespace fs = std::filesystem;
+    close();
+
+    std::error_code error;
+    uint64_t size = fs::exists(logPath, error) ? fs::file_size(logPath, error) : 0;
+    if (error) return false;
+    if (size < sizeof(LogHeader)) {
+        // New log (or one whose creation never finished)
+        LogHeader created;
+        std::memcpy(created.magic, LOG_MAGIC, 4);
+        created.version = FORMAT_VERSION;
+        created.recordSize = sizeof(ScoreRecord);
+        created.reserved = 0;
+        FILE* file = std::fopen(logPath.c_str(), "wb");
+        if (!file) return false;
+        bool written = std::fwrite(&created, sizeof(created), 1, file) == 1;
+        written = std::fclose(file) == 0 && written;
+        if (!written) return false;
+        size = sizeof(LogHeader);
+    }
+
+    // Check the header, then drop a torn tail: a partial record, or whole
+    // records whose checksum does not match
+    uint64_t records = (size - sizeof(LogHeader)) / sizeof(ScoreRecord);
+    {
+        MappedFile mapped;
+        if (!mapped.open(logPath)) return false;
+        LogHeader existing;
+        std::memcpy(&existing, mapped.getData(), sizeof(existing));
+        if (std::memcmp(existing.magic, LOG_MAGIC, 4) != 0 || existing.version != FORMAT_VERSION ||
+            existing.recordSize != sizeof(ScoreRecord)) {
+            return false;
+        }
+        const ScoreRecord* stored = reinterpret_cast<const ScoreRecord*>(mapped.getData() + sizeof(LogHeader));
+        while (records > 0 && stored[records - 1].checksum != checksum(stored[records - 1])) {
+            records--;
+        }
+    }
+    uint64_t validSize = sizeof(LogHeader) + records * sizeof(ScoreRecord);
+    if (validSize != size) {
+        fs::resize_file(logPath, validSize, error);
+        if (error) return false;
+    }
+
+    log = std::fopen(logPath.c_str(), "ab");
+    if (!log) return false;
+    this->logPath = logPath;
+    logRecords = records;
+
+    if (!index.openWritable(indexPath, sizeof(IndexHeader) + capacity * sizeof(ScoreRecord))) {
+        close();
+        return false;
+    }
+    if (!indexValid(records)) {
+        rebuildIndex(logPath, 0);
+    } else if (header()->logRecords < records) {
+        rebuildIndex(logPath, header()->logRecords);
+    }
+    revision++;
+    return true;
+}
+
+void ScoreStore::close() {
+    if (log) {
+        std::fclose(log);
+        log = nullptr;
+    }
+    index.close();
+    logRecords = 0;
+}
+
+bool ScoreStore::indexValid(uint64_t records) {
+    IndexHeader* state = header();
+    if (std::memcmp(state->magic, INDEX_MAGIC, 4) != 0 || state->version != FORMAT_VERSION ||
+        state->capacity != static_cast<uint32_t>(capacity) || state->count > state->capacity ||
+        state->logRecords > records) {
+        return false;
+    }
+    ScoreRecord* top = heap();
+    for (uint32_t i = 0; i < state->count; i++) {
+        if (top[i].checksum != checksum(top[i])) return false;
+    }
+    return std::is_heap(top, top + state->count, better);
+}
+
+void ScoreStore::rebuildIndex(const std::string& logPath, uint64_t from) {
+    IndexHeader* state = header();
+    if (from == 0) {
+        std::memcpy(state->magic, INDEX_MAGIC, 4);
+        state->version = FORMAT_VERSION;
+        state->capacity = static_cast<uint32_t>(capacity);
+        state->count = 0;
+        state->reserved = 0;
+    }
+    state->logRecords = INDEX_DIRTY;
+
+    // One sequential pass over the mapped log
+    MappedFile mapped;
+    if (logRecords > from && mapped.open(logPath)) {
+        const ScoreRecord* stored = reinterpret_cast<const ScoreRecord*>(mapped.getData() + sizeof(LogHeader));
+        for (uint64_t i = from; i < logRecords; i++) {
+            insert(stored[i]);
+        }
+    }
+    state->logRecords = logRecords;
+}
+
+void ScoreStore::insert(const ScoreRecord& record) {
+    IndexHeader* state = header();
+    ScoreRecord* top = heap();
+    if (state->count < state->capacity) {
+        top[state->count] = record;
+        state->count++;
+        std::push_heap(top, top + state->count, better);
+    } else if (state->count > 0 && better(record, top[0])) {
+        std::pop_heap(top, top + state->count, better);
+        top[state->count - 1] = record;
+        std::push_heap(top, top + state->count, better);
+    }
+}
+
+bool ScoreStore::append(ScoreRecord record) {
+    if (!log) return false;
+    record.checksum = checksum(record);
+    if (std::fwrite(&record, sizeof(record), 1, log) != 1 || std::fflush(log) != 0) {
+        rollBackLog();
+        return false;
+    }
+    logRecords++;
+
+    // A crash mid-update leaves the index marked dirty, so it is rebuilt
+    IndexHeader* state = header();
+    state->logRecords = INDEX_DIRTY;
+    insert(record);
+    state->logRecords = logRecords;
+    revision++;
+    return true;
+}
+
+// A short write may have left part of a record behind (or still buffered).
+// The log is opened for appending, so everything after it would land out of
+// step with the record size; cut it back to the last whole record instead.
+bool ScoreStore::rollBackLog() {
+    std::fclose(log);
+    log = nullptr;
+
+    std::error_code error;
+    std::filesystem::resize_file(logPath, sizeof(LogHeader) + logRecords * sizeof(ScoreRecord), error);
+    if (error) return false;
+    log = std::fopen(logPath.c_str(), "ab");
+    return log != nullptr;
+}
+
+const std::vector<ScoreRecord>& ScoreStore::getTop() const {
+    if (sortedRevision != revision) {
+        sortedTop.clear();
+        if (index.isOpen()) {
+            const IndexHeader* state = reinterpret_cast<const IndexHeader*>(index.getData());
+            const ScoreRecord* top = reinterpret_cast<const ScoreRecord*>(index.getData() + sizeof(IndexHeader));
+            sortedTop.assign(top, top + state->count);
+            std::sort(sortedTop.begin(), sortedTop.end(), better);
+        }
+        sortedRevision = revision;
+    }
+    return sortedTop;
+}
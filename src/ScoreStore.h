@@ -0,0 +1,73 @@
+#ifndef SCORESTORE_H
+#define SCORESTORE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+// One finished game as stored on disk (native byte order)
+struct ScoreRecord {
+    int64_t time = 0;           // Unix seconds
+    uint64_t seed = 0;
+    int32_t score = 0;
+    int32_t level = 0;
+    uint32_t ticks = 0;
+    uint32_t checksum = 0;      // Of the fields above; 0 marks a torn write
+};
+
+// Every finished game, kept across runs in two files:
+//  - an append-only log of fixed-size records. Each append is one write,
+//    and a record torn by a crash fails its checksum and is cut off on the
+//    next open, so the log always holds whole games.
+//  - a memory-mapped index holding the best `capacity` records as a binary
+//    min-heap, so a new game costs O(log K) however long the log is. The
+//    index notes how many log records it includes; on open it catches up
+//    with the log, and if it is missing or damaged it is rebuilt from the
+//    log in one sequential pass.
+class ScoreStore {
+private:
+    FILE* log;
+    std::string logPath;
+    MappedFile index;
+    int capacity;
+    uint64_t logRecords;
+    unsigned long long revision;
+    mutable std::vector<ScoreRecord> sortedTop;
+    mutable unsigned long long sortedRevision;
+
+    struct IndexHeader;
+    IndexHeader* header();
+    ScoreRecord* heap();
+    bool indexValid(uint64_t records);
+    void rebuildIndex(const std::string& logPath, uint64_t from);
+    void insert(const ScoreRecord& record);
+    bool rollBackLog();
+
+public:
+    explicit ScoreStore(int capacity = 100);
+    ~ScoreStore();
+    ScoreStore(const ScoreStore&) = delete;
+    ScoreStore& operator=(const ScoreStore&) = delete;
+
+    // Opens (creating if needed) the log and its index. False if either file
+    // cannot be used, e.g. the log belongs to another format.
+    bool open(const std::string& logPath, const std::string& indexPath);
+    void close();
+    bool isOpen() const { return log != nullptr; }
+    // Appends a game to the log and the index. The record's checksum is
+    // filled in here. If the write fails, the log is cut back to its last
+    // whole record (or closed, if that fails too) so later appends stay
+    // aligned.
+    bool append(ScoreRecord record);
+    // Top records, best first: score, then the earlier game on ties. The
+    // vector is rebuilt from the K-entry index only after a change.
+    const std::vector<ScoreRecord>& getTop() const;
+    uint64_t getGameCount() const { return logRecords; }
+    unsigned long long getRevision() const { return revision; }
+
+    static uint32_t checksum(const ScoreRecord& record);
+};
+
+#endif
@@ -0,0 +1,246 @@
+#include "Simulation.h"
+#include <random>
+
+namespace {
+uint64_t mix(uint64_t hash, uint64_t value) {
+    hash ^= value + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+    return hash;
+}
+}
+
+Simulation::Simulation(int width, int height, int maxFood) :
+    gridWidth(width),
+    gridHeight(height),
+    snake(3, height / 2, width, height),
+    food(maxFood, width, height),
+    graph(width, height),
+    levelGenerator(width, height),
+    levelStyle(LEVEL_RANDOM),
+    cycleLayouts(false),
+    freeCells(width, height),
+    alive(false),
+    boardFull(false),
+    deathCause(DEATH_NONE),
+    tickCount(0),
+    seed(0),
+    profiler(nullptr) {}
+
+void Simulation::reset() {
+    std::random_device device;
+    reset((static_cast<uint64_t>(device()) << 32) | device());
+}
+
+void Simulation::reset(uint64_t gameSeed) {
+    seed = gameSeed;
+    levelGenerator.seed(gameSeed);
+    levelGenerator.setCycleLayouts(cycleLayouts);
+    food.seed(gameSeed ^ 0xF00DF00DF00DF00DULL);
+
+    // The snake goes down first so the generator can keep its cells and the
+    // way ahead open. On cycle layouts it starts on an even row, where its
+    // body already lies along a block cycle.
+    scoreManager.reset();
+    snake.reset(5, cycleLayouts ? 4 : 5);
+    levelGenerator.generate(graph, 1, levelStyle, &snake);
+
+    food.clear();
+    freeCells.fill();
+    graph.forEachWall([this](int x, int y) { freeCells.erase(x, y); });
+    for (const auto& segment : snake.getBody()) {
+        freeCells.erase(segment.x, segment.y);
+    }
+    boardFull = false;
+    spawnFood();
+
+    alive = true;
+    deathCause = DEATH_NONE;
+    tickCount = 0;
+}
+
+void Simulation::setDirection(Direction dir) {
+    snake.setDirection(dir);
+}
+
+StepResult Simulation::step(Direction dir) {
+    snake.setDirection(dir);
+    return step();
+}
+
+StepResult Simulation::step() {
+    StepResult result;
+    if (!alive) {
+        result.alive = false;
+        result.cause = deathCause;
+        return result;
+    }
+
+    tickCount++;
+    SnakeSegment oldTail = snake.getTail();
+    bool grew = snake.isGrowing();
+    snake.move();
+    SnakeSegment head = snake.getHead();
+
+    // Keep the free-cell index in step with the body: the tail cell opens up
+    // (unless a level change walled it) and the new head cell closes
+    if (!grew && !graph.isWall(oldTail.x, oldTail.y)) {
+        freeCells.insert(oldTail.x, oldTail.y);
+    }
+    freeCells.erase(head.x, head.y);
+
+    {
+        ProfileScope checks(profiler, PHASE_GRAPH_CHECKS);
+        if (head.x < 0 || head.x >= gridWidth || head.y < 0 || head.y >= gridHeight) {
+            return die(DEATH_BOUNDARY);
+        }
+        if (graph.isWall(head.x, head.y)) {
+            return die(DEATH_WALL);
+        }
+        if (snake.checkSelfCollision()) {
+            return die(DEATH_SELF);
+        }
+    }
+
+    if (food.checkCollision(head.x, head.y)) {
+        result.ateFood = true;
+        snake.grow();
+        scoreManager.addScore(POINTS_PER_FOOD);
+
+        if (scoreManager.getCurrentScore() % POINTS_PER_LEVEL == 0) {
+            result.leveledUp = true;
+            nextLevel();
+        }
+    }
+
+    // Keep the board stocked (also refills after a level change)
+    if (food.getCount() < food.getMaxCount()) {
+        spawnFood();
+    }
+    result.boardFull = boardFull;
+    return result;
+}
+
+int Simulation::stepN(const Direction* actions, int n) {
+    int executed = 0;
+    while (executed < n && alive) {
+        if (actions) {
+            snake.setDirection(actions[executed]);
+        }
+        step();
+        executed++;
+    }
+    return executed;
+}
+
+uint64_t Simulation::getStateHash() const {
+    uint64_t hash = mix(tickCount, alive);
+    hash = mix(hash, static_cast<uint64_t>(scoreManager.getCurrentScore()));
+    hash = mix(hash, static_cast<uint64_t>(scoreManager.getCurrentLevel()));
+    hash = mix(hash, snake.getDirection());
+    for (const auto& segment : snake.getBody()) {
+        hash = mix(hash, static_cast<uint64_t>(segment.y) * gridWidth + segment.x);
+    }
+    for (const auto& position : food.getPositions()) {
+        hash = mix(hash, static_cast<uint64_t>(position.y) * gridWidth + position.x);
+    }
+    return mix(hash, graph.getLayoutHash());
+}
+
+void Simulation::saveState(SimulationState& state) const {
+    state.seed = seed;
+    state.tickCount = tickCount;
+    state.alive = alive;
+    state.boardFull = boardFull;
+    state.deathCause = deathCause;
+    state.body.clear();
+    for (const auto& segment : snake.getBody()) {
+        state.body.push_back(segment);
+    }
+    state.direction = snake.getDirection();
+    state.nextDirection = snake.getNextDirection();
+    state.growing = snake.isGrowing();
+    state.food = food.getPositions();
+    state.foodRngState = food.getRngState();
+    state.layoutRngState = levelGenerator.getRngState();
+    state.scores = scoreManager;
+
+    if (!state.walls || state.layoutHash != graph.getLayoutHash()) {
+        auto walls = std::make_shared<std::vector<int32_t>>();
+        walls->reserve(graph.getWallCount());
+        graph.forEachWall([this, &walls](int x, int y) { walls->push_back(y * gridWidth + x); });
+        state.walls = walls;
+        state.layoutHash = graph.getLayoutHash();
+    }
+}
+
+void Simulation::restoreState(const SimulationState& state) {
+    seed = state.seed;
+    tickCount = state.tickCount;
+    alive = state.alive;
+    boardFull = state.boardFull;
+    deathCause = state.deathCause;
+    snake.restore(state.body, state.direction, state.nextDirection, state.growing);
+    food.clear();
+    for (const auto& position : state.food) {
+        food.spawn(position.x, position.y);
+    }
+    food.setRngState(state.foodRngState);
+    levelGenerator.setRngState(state.layoutRngState);
+    scoreManager = state.scores;
+
+    graph.clearWalls();
+    if (state.walls) {
+        for (int32_t cell : *state.walls) {
+            graph.addWall(cell % gridWidth, cell / gridWidth);
+        }
+    }
+
+    // Free cells are a pure function of the board, so the rebuilt set picks
+    // the same cells the original would have
+    freeCells.fill();
+    graph.forEachWall([this](int x, int y) { freeCells.erase(x, y); });
+    for (const auto& segment : state.body) {
+        freeCells.erase(segment.x, segment.y);
+    }
+    for (const auto& position : state.food) {
+        freeCells.erase(position.x, position.y);
+    }
+}
+
+StepResult Simulation::die(DeathCause cause) {
+    scoreManager.gameOver();
+    alive = false;
+    deathCause = cause;
+
+    StepResult result;
+    result.alive = false;
+    result.cause = cause;
+    return result;
+}
+
+void Simulation::nextLevel() {
+    int newLevel = scoreManager.getCurrentLevel() + 1;
+    scoreManager.setLevel(newLevel);
+
+    // Uneaten food and the old walls give their cells back, except where the
+    // body now lies; then the new walls are taken out
+    clearFood();
+    graph.forEachWall([this](int x, int y) {
+        if (!snake.checkCollision(x, y)) freeCells.insert(x, y);
+    });
+    levelGenerator.generate(graph, newLevel, levelStyle, &snake);
+    graph.forEachWall([this](int x, int y) { freeCells.erase(x, y); });
+}
+
+void Simulation::clearFood() {
+    for (const auto& position : food.getPositions()) {
+        freeCells.insert(position.x, position.y);
+    }
+    food.clear();
+}
+
+void Simulation::spawnFood() {
+    ProfileScope spawn(profiler, PHASE_FOOD_SPAWN);
+    if (!food.spawnRandom(freeCells)) {
+        boardFull = true;
+    }
+}
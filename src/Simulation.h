@@ -0,0 +1,119 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "Snake.h"
+#include "Food.h"
+#include "Graph.h"
+#include "LevelGenerator.h"
+#include "ScoreManager.h"
+#include "FreeCellSet.h"
+#include "Profiler.h"
+#include <memory>
+#include <vector>
+
+enum DeathCause { DEATH_NONE, DEATH_WALL, DEATH_BOUNDARY, DEATH_SELF };
+
+struct StepResult {
+    bool alive = true;
+    bool ateFood = false;
+    bool leveledUp = false;
+    bool boardFull = false;     // No free cell was left to place food on
+    DeathCause cause = DEATH_NONE;
+};
+
+// What a game needs to carry on from one tick, in O(length + food + walls)
+// instead of the board-sized bitsets and free-cell index, which
+// Simulation::restoreState() rebuilds. States saved on one level can share
+// its wall list.
+struct SimulationState {
+    uint64_t seed = 0;
+    unsigned long long tickCount = 0;
+    bool alive = false;
+    bool boardFull = false;
+    DeathCause deathCause = DEATH_NONE;
+    std::vector<SnakeSegment> body;     // Head first
+    Direction direction = RIGHT;
+    Direction nextDirection = RIGHT;
+    bool growing = false;
+    std::vector<Position> food;         // In spawn order
+    uint64_t foodRngState = 0;
+    uint64_t layoutRngState = 0;        // Level generator, for the levels still to come
+    ScoreManager scores;                // Score, level and undo history
+    uint64_t layoutHash = 0;
+    std::shared_ptr<const std::vector<int32_t>> walls;  // Cells (y * width + x)
+};
+
+// Headless game rules: owns all board state and advances it one tick at a
+// time. Contains no rendering, audio or timing so it can run at full speed.
+class Simulation {
+private:
+    int gridWidth, gridHeight;
+    Snake snake;
+    Food food;
+    Graph graph;
+    LevelGenerator levelGenerator;
+    LevelStyle levelStyle;
+    bool cycleLayouts;
+    ScoreManager scoreManager;
+    FreeCellSet freeCells;      // Cells with no wall, body segment or food
+    bool alive;
+    bool boardFull;
+    DeathCause deathCause;
+    unsigned long long tickCount;
+    uint64_t seed;              // Seed of the current game
+    Profiler* profiler;         // Optional; times collision checks and food spawns
+
+    static const int POINTS_PER_FOOD = 10;
+    static const int POINTS_PER_LEVEL = 100;
+
+    void spawnFood();
+    void clearFood();
+    void nextLevel();
+    StepResult die(DeathCause cause);
+
+public:
+    Simulation(int width, int height, int maxFood = 3);
+    // Starts a game from a fresh random seed; reset(seed) makes the wall
+    // layouts and food placements a pure function of seed and inputs
+    void reset();
+    void reset(uint64_t seed);
+    void setProfiler(Profiler* target) { profiler = target; }
+    // Wall layout used from the next reset() on
+    void setLevelStyle(LevelStyle style) { levelStyle = style; }
+    LevelStyle getLevelStyle() const { return levelStyle; }
+    // From the next reset() on, wall only whole 2x2 blocks and keep the body
+    // on a block cycle across levels (LevelGenerator::setCycleLayouts)
+    void setCycleLayouts(bool enabled) { cycleLayouts = enabled; }
+    bool getCycleLayouts() const { return cycleLayouts; }
+    const LevelStats& getLevelStats() const { return levelGenerator.getStats(); }
+    void setDirection(Direction dir);
+    StepResult step();
+    StepResult step(Direction dir);
+    // Runs up to n ticks, applying actions[i] before tick i (nullptr keeps
+    // the current heading). Stops early on death; returns ticks executed.
+    int stepN(const Direction* actions, int n);
+
+    bool isAlive() const { return alive; }
+    bool isBoardFull() const { return boardFull; }
+    DeathCause getDeathCause() const { return deathCause; }
+    unsigned long long getTickCount() const { return tickCount; }
+    uint64_t getSeed() const { return seed; }
+    // Digest of the gameplay state (snake, food, walls, score), for checking
+    // that a replay follows the recorded game
+    uint64_t getStateHash() const;
+    // Keeps state.walls when it already holds the current layout, so states
+    // saved on one level share a single wall list
+    void saveState(SimulationState& state) const;
+    void restoreState(const SimulationState& state);
+    int getWidth() const { return gridWidth; }
+    int getHeight() const { return gridHeight; }
+
+    const Snake& getSnake() const { return snake; }
+    const Food& getFood() const { return food; }
+    const Graph& getGraph() const { return graph; }
+    const ScoreManager& getScoreManager() const { return scoreManager; }
+    const FreeCellSet& getFreeCells() const { return freeCells; }
+    ScoreManager& getScoreManager() { return scoreManager; }
+};
+
+#endif
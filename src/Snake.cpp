@@ -1,16 +1,75 @@
 #include "Snake.h"
 
-Snake::Snake(int startX, int startY) : direction(RIGHT), nextDirection(RIGHT), growing(false) {
-    body.push_back(SnakeSegment(startX, startY));
-    body.push_back(SnakeSegment(startX - 1, startY));
-    body.push_back(SnakeSegment(startX - 2, startY));
+Snake::Snake(int startX, int startY, int gridWidth, int gridHeight) :
+    ringMask(0), headIndex(0), length(0),
+    gridWidth(gridWidth), gridHeight(gridHeight),
+    direction(RIGHT), nextDirection(RIGHT), growing(false), selfCollision(false),
+    hasVacated(false) {
+    // The snake can never be longer than the board (plus the colliding head).
+    // Small boards get that capacity up front so move() never reallocates;
+    // large ones start at INITIAL_RING and double as the snake grows.
+    long long needed = static_cast<long long>(gridWidth) * gridHeight + 1;
+    int capacity = 4;
+    while (capacity < needed && capacity < INITIAL_RING) capacity <<= 1;
+    ring.resize(capacity);
+    ringMask = capacity - 1;
+    occupancy.assign((static_cast<size_t>(gridWidth) * gridHeight + 63) / 64, 0);
+
+    reset(startX, startY);
+}
+
+bool Snake::testCell(int x, int y) const {
+    size_t index = static_cast<size_t>(y) * gridWidth + x;
+    return (occupancy[index >> 6] >> (index & 63)) & 1;
+}
+
+void Snake::setCell(int x, int y) {
+    size_t index = static_cast<size_t>(y) * gridWidth + x;
+    occupancy[index >> 6] |= uint64_t(1) << (index & 63);
+}
+
+void Snake::clearCell(int x, int y) {
+    size_t index = static_cast<size_t>(y) * gridWidth + x;
+    occupancy[index >> 6] &= ~(uint64_t(1) << (index & 63));
+}
+
+void Snake::pushHead(const SnakeSegment& segment) {
+    if (length == ringMask + 1) growRing();
+
+    headIndex = (headIndex + 1) & ringMask;
+    ring[headIndex] = segment;
+    length++;
+
+    if (inGrid(segment.x, segment.y)) {
+        // The tail has already been popped, so a set bit means the head ran
+        // into the body. After that the bitset is no longer exact, which is
+        // fine because the game is over until reset().
+        if (testCell(segment.x, segment.y)) selfCollision = true;
+        setCell(segment.x, segment.y);
+    }
+}
+
+void Snake::popTail() {
+    const SnakeSegment& tail = ring[(headIndex - length + 1) & ringMask];
+    if (inGrid(tail.x, tail.y)) clearCell(tail.x, tail.y);
+    length--;
+}
+
+void Snake::growRing() {
+    // Keeps order head-last
+    std::vector<SnakeSegment> larger(ring.size() * 2);
+    for (int i = 0; i < length; i++) {
+        larger[i] = ring[(headIndex - length + 1 + i) & ringMask];
+    }
+    ring.swap(larger);
+    ringMask = static_cast<int>(ring.size()) - 1;
+    headIndex = length - 1;
 }
 
 void Snake::move() {
     direction = nextDirection;
     
-    SnakeSegment head = body.front();
-    SnakeSegment newHead = head;
+    SnakeSegment newHead = ring[headIndex];
     
     switch (direction) {
         case UP: newHead.y--; break;
@@ -19,13 +78,16 @@ void Snake::move() {
         case RIGHT: newHead.x++; break;
     }
     
-    body.push_front(newHead);
-    
+    // Pop before push so the head may follow into the cell the tail leaves
+    hasVacated = !growing;
     if (!growing) {
-        body.pop_back();
+        vacated = getTail();
+        popTail();
     } else {
         growing = false;
     }
+
+    pushHead(newHead);
 }
 
 void Snake::grow() {
@@ -43,59 +105,50 @@ void Snake::setDirection(Direction dir) {
 }
 
 bool Snake::checkSelfCollision() const {
-    const SnakeSegment& head = body.front();
-    auto it = body.begin();
-    ++it; // Skip head
-    
-    for (; it != body.end(); ++it) {
-        if (head.x == it->x && head.y == it->y) {
-            return true;
-        }
-    }
-    return false;
+    return selfCollision;
 }
 
 bool Snake::checkCollision(int x, int y) const {
-    for (const auto& segment : body) {
-        if (segment.x == x && segment.y == y) {
-            return true;
-        }
-    }
-    return false;
+    return inGrid(x, y) && testCell(x, y);
 }
 
-void Snake::render(sf::RenderWindow& window, int cellSize) const {
-    sf::RectangleShape segment(sf::Vector2f(cellSize - 2, cellSize - 2));
-    
-    bool isHead = true;
-    for (const auto& bodySegment : body) {
-        segment.setPosition(bodySegment.x * cellSize + 1, bodySegment.y * cellSize + 1);
-        
-        if (isHead) {
-            segment.setFillColor(sf::Color::Green);
-            isHead = false;
-        } else {
-            segment.setFillColor(sf::Color(100, 255, 100));
-        }
-        
-        window.draw(segment);
-    }
+SnakeSegment Snake::getHead() const {
+    return ring[headIndex];
 }
 
-SnakeSegment Snake::getHead() const {
-    return body.front();
+SnakeSegment Snake::getTail() const {
+    return ring[(headIndex - length + 1) & ringMask];
 }
 
 int Snake::getLength() const {
-    return body.size();
+    return length;
 }
 
 void Snake::reset(int startX, int startY) {
-    body.clear();
-    body.push_back(SnakeSegment(startX, startY));
-    body.push_back(SnakeSegment(startX - 1, startY));
-    body.push_back(SnakeSegment(startX - 2, startY));
+    while (length > 0) popTail();
+    headIndex = 0;
+
+    // Tail first so the head ends up at headIndex
+    selfCollision = false;
+    hasVacated = false;
+    pushHead(SnakeSegment(startX - 2, startY));
+    pushHead(SnakeSegment(startX - 1, startY));
+    pushHead(SnakeSegment(startX, startY));
     direction = RIGHT;
     nextDirection = RIGHT;
     growing = false;
-}
\ No newline at end of file
+}
+
+void Snake::restore(const std::vector<SnakeSegment>& body, Direction current, Direction next, bool isGrowing) {
+    while (length > 0) popTail();
+    headIndex = 0;
+
+    selfCollision = false;
+    hasVacated = false;
+    for (auto it = body.rbegin(); it != body.rend(); ++it) {
+        pushHead(*it);
+    }
+    direction = current;
+    nextDirection = next;
+    growing = isGrowing;
+}
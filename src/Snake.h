@@ -1,8 +1,9 @@
 #ifndef SNAKE_H
 #define SNAKE_H
 
-#include <SFML/Graphics.hpp>
-#include <list>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
 
 enum Direction { UP, DOWN, LEFT, RIGHT };
 
@@ -11,25 +12,90 @@ struct SnakeSegment {
     SnakeSegment(int x = 0, int y = 0) : x(x), y(y) {}
 };
 
+// Non-owning view of the snake body, head first. Valid until the next
+// move() or reset() of the snake it came from.
+class SnakeBodyView {
+private:
+    const SnakeSegment* ring;
+    int mask;
+    int headIndex;
+    int count;
+
+public:
+    class iterator {
+    private:
+        const SnakeBodyView* view;
+        int offset;
+    public:
+        iterator(const SnakeBodyView* v, int o) : view(v), offset(o) {}
+        const SnakeSegment& operator*() const { return (*view)[offset]; }
+        const SnakeSegment* operator->() const { return &(*view)[offset]; }
+        iterator& operator++() { ++offset; return *this; }
+        bool operator==(const iterator& other) const { return offset == other.offset; }
+        bool operator!=(const iterator& other) const { return offset != other.offset; }
+    };
+
+    SnakeBodyView(const SnakeSegment* r, int m, int h, int n) : ring(r), mask(m), headIndex(h), count(n) {}
+    // i = 0 is the head, size() - 1 the tail
+    const SnakeSegment& operator[](int i) const { return ring[(headIndex - i) & mask]; }
+    int size() const { return count; }
+    // Slot of segment i in the snake's ring; slots of consecutive segments
+    // are consecutive modulo ringMask() + 1
+    int ringIndex(int i) const { return (headIndex - i) & mask; }
+    int ringMask() const { return mask; }
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, count); }
+};
+
+// Body is a power-of-two ring buffer (head pushed, tail popped in place) plus
+// one occupancy bit per grid cell, so moves never allocate and collision
+// queries are O(1). Segments outside the grid are kept in the ring but have
+// no occupancy bit.
 class Snake {
 private:
-    std::list<SnakeSegment> body;
+    std::vector<SnakeSegment> ring;
+    std::vector<uint64_t> occupancy;
+    int ringMask;
+    int headIndex;
+    int length;
+    int gridWidth, gridHeight;
     Direction direction;
     Direction nextDirection;
     bool growing;
+    bool selfCollision;
+    bool hasVacated;
+    SnakeSegment vacated;       // Tail cell given up by the last move()
+
+    static const int INITIAL_RING = 1 << 16;
+
+    bool inGrid(int x, int y) const { return x >= 0 && x < gridWidth && y >= 0 && y < gridHeight; }
+    bool testCell(int x, int y) const;
+    void setCell(int x, int y);
+    void clearCell(int x, int y);
+    void pushHead(const SnakeSegment& segment);
+    void popTail();
+    void growRing();
 
 public:
-    Snake(int startX, int startY);
+    Snake(int startX, int startY, int gridWidth, int gridHeight);
     void move();
     void grow();
     void setDirection(Direction dir);
     bool checkSelfCollision() const;
     bool checkCollision(int x, int y) const;
-    void render(sf::RenderWindow& window, int cellSize) const;
     SnakeSegment getHead() const;
+    SnakeSegment getTail() const;
+    Direction getDirection() const { return direction; }
+    Direction getNextDirection() const { return nextDirection; }
+    bool isGrowing() const { return growing; }
+    // False when the last move grew the snake (or after reset)
+    bool hasVacatedCell() const { return hasVacated; }
+    SnakeSegment getVacatedCell() const { return vacated; }
     int getLength() const;
     void reset(int startX, int startY);
-    std::list<SnakeSegment> getBody() const { return body; }
+    // Replaces the body (head first) and heading, e.g. from a saved state
+    void restore(const std::vector<SnakeSegment>& body, Direction current, Direction next, bool isGrowing);
+    SnakeBodyView getBody() const { return SnakeBodyView(ring.data(), ringMask, headIndex, length); }
 };
 
-#endif
\ No newline at end of file
+#endif
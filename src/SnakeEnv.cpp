@@ -0,0 +1,272 @@
+#include "SnakeEnv.h"
+#include "Simulation.h"
+#include "MappedFile.h"
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <vector>
+
+static_assert(sizeof(SnakeEnvRing) == 64, "SnakeEnvRing is a shared layout");
+static_assert(sizeof(SnakeEnvFrame) == 64, "SnakeEnvFrame is a shared layout");
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "sequence fields are stored atomically");
+
+namespace {
+const char RING_MAGIC[4] = {'S', 'N', 'K', 'E'};
+
+size_t alignUp(size_t value) {
+    return (value + 63) & ~size_t(63);
+}
+
+size_t frameBytes(const SnakeEnvConfig& config) {
+    return alignUp(sizeof(SnakeEnvFrame) + SNAKE_ENV_PLANE_COUNT * static_cast<size_t>(config.width) * config.height);
+}
+
+bool validConfig(const SnakeEnvConfig* config) {
+    return config && config->width >= 8 && config->height >= 8 &&
+           static_cast<long long>(config->width) * config->height <= (1 << 26) && config->max_food >= 1 &&
+           config->level_style >= 0 && config->level_style < LEVEL_STYLE_COUNT && config->frame_count >= 1;
+}
+
+void storeRelease(uint64_t* field, uint64_t value) {
+    reinterpret_cast<std::atomic<uint64_t>*>(field)->store(value, std::memory_order_release);
+}
+}
+
+struct SnakeEnv {
+    Simulation simulation;
+    MappedFile shared;
+    std::vector<uint64_t> owned;
+    SnakeEnvRing* ring;
+    int width, height;
+    int frameCount;
+    uint64_t sequence;
+
+    // Cells changed by each of the last frameCount frames, so a slot can be
+    // brought forward from the frame it held; `full` marks a frame that
+    // changed everything (reset or new level)
+    int maxChanges;
+    std::vector<int32_t> journal;
+    std::vector<int32_t> journalCounts;
+    std::vector<uint8_t> journalFull;
+    std::vector<Position> lastFood;
+    unsigned long long lastFoodRevision;
+
+    SnakeEnv(const SnakeEnvConfig& config) :
+        simulation(config.width, config.height, config.max_food),
+        ring(nullptr),
+        width(config.width),
+        height(config.height),
+        frameCount(config.frame_count),
+        sequence(0),
+        maxChanges(3 + 2 * config.max_food),
+        journal(static_cast<size_t>(config.frame_count) * (3 + 2 * config.max_food)),
+        journalCounts(config.frame_count, 0),
+        journalFull(config.frame_count, 1),
+        lastFoodRevision(0) {
+        simulation.setLevelStyle(static_cast<LevelStyle>(config.level_style));
+        lastFood.reserve(config.max_food);
+    }
+
+    void attach(void* buffer, const SnakeEnvConfig& config) {
+        ring = static_cast<SnakeEnvRing*>(buffer);
+        std::memset(ring, 0, sizeof(SnakeEnvRing));
+        std::memcpy(ring->magic, RING_MAGIC, 4);
+        ring->version = SNAKE_ENV_VERSION;
+        ring->width = static_cast<uint32_t>(width);
+        ring->height = static_cast<uint32_t>(height);
+        ring->frame_count = static_cast<uint32_t>(frameCount);
+        ring->frame_size = static_cast<uint32_t>(frameBytes(config));
+        ring->frames_offset = static_cast<uint32_t>(sizeof(SnakeEnvRing));
+        ring->plane_offset = static_cast<uint32_t>(sizeof(SnakeEnvFrame));
+        for (int slot = 0; slot < frameCount; slot++) {
+            std::memset(frame(slot), 0, sizeof(SnakeEnvFrame));
+        }
+    }
+
+    SnakeEnvFrame* frame(uint64_t number) {
+        return const_cast<SnakeEnvFrame*>(snake_env_ring_frame(ring, number));
+    }
+
+    uint8_t* plane(SnakeEnvFrame* target, int index) {
+        return const_cast<uint8_t*>(snake_env_plane(ring, target, index));
+    }
+
+    void note(int slot, int x, int y) {
+        if (x < 0 || x >= width || y < 0 || y >= height || journalCounts[slot] == maxChanges) return;
+        journal[static_cast<size_t>(slot) * maxChanges + journalCounts[slot]++] = y * width + x;
+    }
+
+    void noteFood(int slot) {
+        // Old and new food cells, only when the food changed
+        const Food& food = simulation.getFood();
+        if (food.getRevision() == lastFoodRevision) return;
+        for (const Position& position : lastFood) note(slot, position.x, position.y);
+        for (const Position& position : food.getPositions()) note(slot, position.x, position.y);
+        lastFood.assign(food.getPositions().begin(), food.getPositions().end());
+        lastFoodRevision = food.getRevision();
+    }
+
+    void drawCell(SnakeEnvFrame* target, int cell) {
+        int x = cell % width;
+        int y = cell / width;
+        SnakeSegment head = simulation.getSnake().getHead();
+        plane(target, SNAKE_ENV_PLANE_WALL)[cell] = simulation.getGraph().isWall(x, y);
+        plane(target, SNAKE_ENV_PLANE_BODY)[cell] =
+            (head.x == x && head.y == y) ? 2 : simulation.getSnake().checkCollision(x, y);
+        plane(target, SNAKE_ENV_PLANE_FOOD)[cell] = simulation.getFood().contains(x, y);
+    }
+
+    void drawAll(SnakeEnvFrame* target) {
+        std::memset(plane(target, 0), 0, SNAKE_ENV_PLANE_COUNT * static_cast<size_t>(width) * height);
+        uint8_t* walls = plane(target, SNAKE_ENV_PLANE_WALL);
+        uint8_t* body = plane(target, SNAKE_ENV_PLANE_BODY);
+        uint8_t* food = plane(target, SNAKE_ENV_PLANE_FOOD);
+        simulation.getGraph().forEachWall([&](int x, int y) { walls[y * width + x] = 1; });
+        bool head = true;
+        for (const SnakeSegment& segment : simulation.getSnake().getBody()) {
+            if (segment.x >= 0 && segment.x < width && segment.y >= 0 && segment.y < height) {
+                body[segment.y * width + segment.x] = head ? 2 : 1;
+            }
+            head = false;
+        }
+        for (const Position& position : simulation.getFood().getPositions()) {
+            food[position.y * width + position.x] = 1;
+        }
+    }
+
+    // Writes frame `sequence` from the current state into its slot
+    const SnakeEnvFrame* publish(float reward) {
+        SnakeEnvFrame* target = frame(sequence);
+        storeRelease(&target->sequence, 0);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        bool full = false;
+        for (int slot = 0; slot < frameCount; slot++) {
+            full |= journalFull[slot] != 0;
+        }
+        if (full) {
+            drawAll(target);
+        } else {
+            for (int slot = 0; slot < frameCount; slot++) {
+                const int32_t* cells = &journal[static_cast<size_t>(slot) * maxChanges];
+                for (int i = 0; i < journalCounts[slot]; i++) drawCell(target, cells[i]);
+            }
+        }
+
+        const ScoreManager& scores = simulation.getScoreManager();
+        SnakeSegment head = simulation.getSnake().getHead();
+        target->tick = simulation.getTickCount();
+        target->seed = simulation.getSeed();
+        target->score = scores.getCurrentScore();
+        target->level = scores.getCurrentLevel();
+        target->length = simulation.getSnake().getLength();
+        target->alive = simulation.isAlive();
+        target->death_cause = simulation.getDeathCause();
+        target->board_full = simulation.isBoardFull();
+        target->head_x = head.x;
+        target->head_y = head.y;
+        target->food_count = simulation.getFood().getCount();
+        target->reward = reward;
+
+        storeRelease(&target->sequence, sequence);
+        storeRelease(&ring->latest, sequence);
+        return target;
+    }
+
+    // Starts the journal entry of the next frame
+    int beginFrame(bool full) {
+        sequence++;
+        int slot = static_cast<int>(sequence % frameCount);
+        journalCounts[slot] = 0;
+        journalFull[slot] = full;
+        return slot;
+    }
+};
+
+extern "C" {
+
+size_t snake_env_buffer_size(const SnakeEnvConfig* config) {
+    if (!validConfig(config)) return 0;
+    return sizeof(SnakeEnvRing) + static_cast<size_t>(config->frame_count) * frameBytes(*config);
+}
+
+SnakeEnv* snake_env_create(const SnakeEnvConfig* config, void* buffer, size_t size) {
+    size_t needed = snake_env_buffer_size(config);
+    if (needed == 0) return nullptr;
+    if (buffer && (size < needed || reinterpret_cast<uintptr_t>(buffer) % 8 != 0)) return nullptr;
+
+    // No exceptions may cross the C boundary
+    SnakeEnv* env = nullptr;
+    try {
+        env = new SnakeEnv(*config);
+        if (!buffer) {
+            env->owned.assign((needed + 7) / 8, 0);
+            buffer = env->owned.data();
+        }
+    } catch (const std::bad_alloc&) {
+        delete env;
+        return nullptr;
+    }
+    env->attach(buffer, *config);
+    return env;
+}
+
+SnakeEnv* snake_env_create_shared(const SnakeEnvConfig* config, const char* path) {
+    size_t needed = snake_env_buffer_size(config);
+    if (needed == 0 || !path) return nullptr;
+    SnakeEnv* env = nullptr;
+    try {
+        env = new SnakeEnv(*config);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+    if (!env->shared.openWritable(path, needed)) {
+        delete env;
+        return nullptr;
+    }
+    env->attach(env->shared.getWritableData(), *config);
+    return env;
+}
+
+void snake_env_close(SnakeEnv* env) {
+    delete env;
+}
+
+const SnakeEnvFrame* snake_env_reset(SnakeEnv* env, uint64_t seed) {
+    env->simulation.reset(seed);
+    env->beginFrame(true);
+    env->lastFood.assign(env->simulation.getFood().getPositions().begin(),
+                         env->simulation.getFood().getPositions().end());
+    env->lastFoodRevision = env->simulation.getFood().getRevision();
+    return env->publish(0.0f);
+}
+
+const SnakeEnvFrame* snake_env_step(SnakeEnv* env, int action) {
+    Simulation& simulation = env->simulation;
+    if (env->sequence == 0 || !simulation.isAlive()) return snake_env_latest(env);
+
+    SnakeSegment oldHead = simulation.getSnake().getHead();
+    StepResult result = action >= SNAKE_ENV_UP && action <= SNAKE_ENV_RIGHT
+                            ? simulation.step(static_cast<Direction>(action))
+                            : simulation.step();
+
+    const Snake& snake = simulation.getSnake();
+    int slot = env->beginFrame(result.leveledUp);
+    if (snake.hasVacatedCell()) env->note(slot, snake.getVacatedCell().x, snake.getVacatedCell().y);
+    env->note(slot, oldHead.x, oldHead.y);
+    env->note(slot, snake.getHead().x, snake.getHead().y);
+    env->noteFood(slot);
+
+    float reward = !result.alive ? -1.0f : (result.ateFood ? 1.0f : 0.0f);
+    return env->publish(reward);
+}
+
+const SnakeEnvRing* snake_env_ring(const SnakeEnv* env) {
+    return env->ring;
+}
+
+const SnakeEnvFrame* snake_env_latest(const SnakeEnv* env) {
+    return env->sequence == 0 ? nullptr : snake_env_ring_frame(env->ring, env->sequence);
+}
+
+}
@@ -0,0 +1,126 @@
+#ifndef SNAKEENV_H
+#define SNAKEENV_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// C interface to one headless game, for trainers written in other languages.
+// Every reset and step publishes an observation frame into a ring of
+// fixed-layout frames that the caller reads in place: in memory the caller
+// provides, in memory the environment owns, or in a file mapping that other
+// processes can map too (e.g. a path under /dev/shm).
+//
+// Buffer layout (native byte order, every block 64-byte aligned):
+//   SnakeEnvRing header
+//   frame_count frames of frame_size bytes, each:
+//     SnakeEnvFrame header
+//     SNAKE_ENV_PLANE_COUNT planes of width * height bytes, row-major
+// The frame with sequence s lives in slot s % frame_count. Planes are kept
+// up to date incrementally: a step rewrites only the cells that changed
+// since the slot was last used (head, tail and food cells), and the whole
+// frame is redrawn only after a reset or a level change.
+//
+// A frame's sequence field reads 0 while the frame is being rewritten and
+// its number once it is complete; the ring's latest field is updated after
+// that. Both are stored with release ordering, so a reader in another
+// process reads the sequence, the frame, then the sequence again, and keeps
+// the frame if both reads match (a seqlock).
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNAKE_ENV_VERSION 1
+
+enum {
+    SNAKE_ENV_PLANE_WALL,       // 1 on walls
+    SNAKE_ENV_PLANE_BODY,       // 1 on body segments, 2 on the head
+    SNAKE_ENV_PLANE_FOOD,       // 1 on food
+    SNAKE_ENV_PLANE_COUNT
+};
+
+// Actions for snake_env_step; the values match the game's Direction
+enum {
+    SNAKE_ENV_KEEP = -1,
+    SNAKE_ENV_UP = 0,
+    SNAKE_ENV_DOWN = 1,
+    SNAKE_ENV_LEFT = 2,
+    SNAKE_ENV_RIGHT = 3
+};
+
+typedef struct SnakeEnvConfig {
+    int width;
+    int height;
+    int max_food;               // Food items kept on the board (the game uses 3)
+    int level_style;            // LevelStyle: 0 random, 1 maze, 2 rooms, 3 symmetric
+    int frame_count;            // Frames in the ring, at least 1
+} SnakeEnvConfig;
+
+typedef struct SnakeEnvRing {
+    char magic[4];              // "SNKE"
+    uint32_t version;           // SNAKE_ENV_VERSION
+    uint32_t width;
+    uint32_t height;
+    uint32_t frame_count;
+    uint32_t frame_size;        // Bytes per frame, header included
+    uint32_t frames_offset;     // Bytes from the ring header to frame 0
+    uint32_t plane_offset;      // Bytes from a frame header to its first plane
+    uint64_t latest;            // Sequence of the newest complete frame
+    uint64_t reserved[3];
+} SnakeEnvRing;
+
+typedef struct SnakeEnvFrame {
+    uint64_t sequence;          // 1 for the first reset, +1 per published frame
+    uint64_t tick;              // Ticks since the last reset
+    uint64_t seed;              // Seed of the current game
+    int32_t score;
+    int32_t level;
+    int32_t length;
+    int32_t alive;
+    int32_t death_cause;        // DeathCause: 0 none, 1 wall, 2 boundary, 3 self
+    int32_t board_full;         // No free cell was left to place food on
+    int32_t head_x;
+    int32_t head_y;
+    int32_t food_count;
+    float reward;               // +1 for food, -1 for a death, else 0
+} SnakeEnvFrame;
+
+typedef struct SnakeEnv SnakeEnv;
+
+// Bytes needed for a ring of the given configuration, or 0 if it is invalid
+size_t snake_env_buffer_size(const SnakeEnvConfig* config);
+
+// Creates an environment writing into buffer (8-byte aligned, at least
+// snake_env_buffer_size bytes, owned by the caller), or into memory of its
+// own when buffer is NULL. Returns NULL on an invalid configuration or
+// buffer.
+SnakeEnv* snake_env_create(const SnakeEnvConfig* config, void* buffer, size_t size);
+// Same, with the ring in a file mapping at path, created or resized to fit
+SnakeEnv* snake_env_create_shared(const SnakeEnvConfig* config, const char* path);
+void snake_env_close(SnakeEnv* env);
+
+// Starts a new game; the same seed and actions give the same frames
+const SnakeEnvFrame* snake_env_reset(SnakeEnv* env, uint64_t seed);
+// Advances one tick with a SNAKE_ENV_* action (a reversal is ignored). After
+// the game has ended it publishes nothing and returns the last frame.
+const SnakeEnvFrame* snake_env_step(SnakeEnv* env, int action);
+
+const SnakeEnvRing* snake_env_ring(const SnakeEnv* env);
+// Newest frame, or NULL before the first reset
+const SnakeEnvFrame* snake_env_latest(const SnakeEnv* env);
+
+// Frame slot and plane addressing, usable on any mapping of a ring
+static inline const SnakeEnvFrame* snake_env_ring_frame(const SnakeEnvRing* ring, uint64_t sequence) {
+    return (const SnakeEnvFrame*)((const uint8_t*)ring + ring->frames_offset +
+                                  (size_t)(sequence % ring->frame_count) * ring->frame_size);
+}
+
+static inline const uint8_t* snake_env_plane(const SnakeEnvRing* ring, const SnakeEnvFrame* frame, int plane) {
+    return (const uint8_t*)frame + ring->plane_offset + (size_t)plane * ring->width * ring->height;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
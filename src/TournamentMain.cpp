@@ -0,0 +1,299 @@
+#include "Simulation.h"
+#include "Autopilot.h"
+#include "HamiltonianSolver.h"
+#include "MctsPlanner.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Headless self-play tournament: plays many complete games with an AI policy
+// across all cores and reports the score/level distribution and deaths.
+//   snake_tournament [--games N] [--threads N] [--policy greedy|hamiltonian|mcts]
+//                    [--grid WxH] [--style name] [--seed S] [--max-ticks T]
+//                    [--budget ms] [--scaling]
+// Game i always runs from seed S + i, so the results do not depend on the
+// thread count (except with mcts, whose search depends on timing); --scaling
+// replays the same games on 1, 2, 4 .. N threads. mcts games each search
+// single-threaded for --budget milliseconds per tick.
+
+namespace {
+enum Policy { POLICY_GREEDY, POLICY_HAMILTONIAN, POLICY_MCTS };
+
+const int SCORE_BUCKET = 50;            // Points per score histogram bucket
+const int MAX_LEVEL_BUCKET = 32;        // Levels above this share the last bucket
+
+// Outcome counts that are not a DeathCause
+const int OUTCOME_BOARD_FULL = DEATH_SELF + 1;
+const int OUTCOME_TIMEOUT = DEATH_SELF + 2;
+const int OUTCOME_COUNT = DEATH_SELF + 3;
+
+struct Options {
+    long long games = 10000;
+    int threads = 0;
+    Policy policy = POLICY_GREEDY;
+    int width = 30;
+    int height = 20;
+    LevelStyle style = LEVEL_RANDOM;
+    uint64_t seed = 1;
+    long long maxTicks = 100000;
+    double budgetMillis = 2.0;
+    bool scaling = false;
+};
+
+// Everything one worker learns, merged only after the run. Each worker
+// writes only its own (cache-line aligned) copy, so counting is contention
+// free.
+struct alignas(64) TournamentStats {
+    long long games = 0;
+    long long ticks = 0;
+    long long scoreTotal = 0;
+    int bestScore = 0;
+    uint64_t bestSeed = 0;
+    long long outcomes[OUTCOME_COUNT] = {};
+    std::vector<long long> scoreBuckets;
+    long long levels[MAX_LEVEL_BUCKET + 1] = {};
+
+    void add(const Simulation& simulation, int outcome) {
+        int score = simulation.getScoreManager().getCurrentScore();
+        games++;
+        ticks += static_cast<long long>(simulation.getTickCount());
+        scoreTotal += score;
+        if (score > bestScore || games == 1) {
+            bestScore = score;
+            bestSeed = simulation.getSeed();
+        }
+        outcomes[outcome]++;
+        size_t bucket = static_cast<size_t>(score / SCORE_BUCKET);
+        if (bucket >= scoreBuckets.size()) scoreBuckets.resize(bucket + 1, 0);
+        scoreBuckets[bucket]++;
+        levels[std::min(simulation.getScoreManager().getCurrentLevel(), MAX_LEVEL_BUCKET)]++;
+    }
+
+    void merge(const TournamentStats& other) {
+        if (other.games > 0 && (games == 0 || other.bestScore > bestScore ||
+                                (other.bestScore == bestScore && other.bestSeed < bestSeed))) {
+            bestScore = other.bestScore;
+            bestSeed = other.bestSeed;
+        }
+        games += other.games;
+        ticks += other.ticks;
+        scoreTotal += other.scoreTotal;
+        for (int i = 0; i < OUTCOME_COUNT; i++) outcomes[i] += other.outcomes[i];
+        if (other.scoreBuckets.size() > scoreBuckets.size()) scoreBuckets.resize(other.scoreBuckets.size(), 0);
+        for (size_t i = 0; i < other.scoreBuckets.size(); i++) scoreBuckets[i] += other.scoreBuckets[i];
+        for (int i = 0; i <= MAX_LEVEL_BUCKET; i++) levels[i] += other.levels[i];
+    }
+};
+
+// One worker's game state, reused from game to game
+struct Player {
+    Simulation simulation;
+    Autopilot autopilot;
+    HamiltonianSolver hamiltonian;
+    std::unique_ptr<MctsPlanner> mcts;
+    TournamentStats stats;
+
+    Player(const Options& options) :
+        simulation(options.width, options.height, 3),
+        autopilot(options.width, options.height),
+        hamiltonian(options.width, options.height) {
+        simulation.setLevelStyle(options.style);
+        simulation.setCycleLayouts(options.policy == POLICY_HAMILTONIAN);
+        if (options.policy == POLICY_MCTS) mcts.reset(new MctsPlanner(options.width, options.height, 3, 1));
+    }
+
+    Direction decide(const Options& options) {
+        switch (options.policy) {
+            case POLICY_HAMILTONIAN: return hamiltonian.decide(simulation);
+            case POLICY_MCTS: return mcts->decide(simulation, options.budgetMillis);
+            default: return autopilot.decide(simulation);
+        }
+    }
+
+    void play(const Options& options, uint64_t seed) {
+        simulation.reset(seed);
+        if (options.policy == POLICY_HAMILTONIAN) hamiltonian.prepare(simulation);
+
+        int outcome = OUTCOME_TIMEOUT;
+        while (simulation.getTickCount() < static_cast<unsigned long long>(options.maxTicks)) {
+            StepResult result = simulation.step(decide(options));
+            if (!result.alive) {
+                outcome = result.cause;
+                break;
+            }
+            if (result.boardFull) {
+                outcome = OUTCOME_BOARD_FULL;
+                break;
+            }
+            if (result.leveledUp && options.policy == POLICY_HAMILTONIAN) {
+                hamiltonian.prepare(simulation);
+            }
+        }
+        stats.add(simulation, outcome);
+    }
+};
+
+struct RunResult {
+    TournamentStats totals;
+    double seconds = 0;
+    unsigned long long steals = 0;
+    MctsStats search;           // Summed over players (mcts only)
+};
+
+RunResult runTournament(const Options& options, int threads) {
+    WorkStealingPool pool(threads);
+    std::vector<std::unique_ptr<Player>> players;
+    for (int i = 0; i < pool.getThreadCount(); i++) {
+        players.emplace_back(new Player(options));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    pool.parallelFor(options.games, 16, [&](long long game, int worker) {
+        players[worker]->play(options, options.seed + static_cast<uint64_t>(game));
+    });
+    RunResult result;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.steals = pool.getStealCount();
+    for (const auto& player : players) {
+        result.totals.merge(player->stats);
+        if (!player->mcts) continue;
+        const MctsStats& search = player->mcts->getStats();
+        result.search.decisions += search.decisions;
+        result.search.rollouts += search.rollouts;
+        result.search.averageMillis += search.averageMillis * search.decisions;
+        result.search.maxMillis = std::max(result.search.maxMillis, search.maxMillis);
+    }
+    if (result.search.decisions > 0) result.search.averageMillis /= result.search.decisions;
+    return result;
+}
+
+void printReport(const Options& options, const RunResult& run, int threads) {
+    const TournamentStats& stats = run.totals;
+    std::printf("%lld games on %d thread(s) in %.2f s: %.0f games/s, %.0f ticks/s, %llu steals\n",
+                stats.games, threads, run.seconds, stats.games / run.seconds, stats.ticks / run.seconds, run.steals);
+    if (run.search.decisions > 0) {
+        double searchSeconds = run.search.averageMillis * run.search.decisions / 1000.0;
+        std::printf("mcts: %llu decisions, %.0f rollouts/s per thread, decision %.2f ms avg, %.2f ms max\n",
+                    run.search.decisions, run.search.rollouts / searchSeconds, run.search.averageMillis,
+                    run.search.maxMillis);
+    }
+    std::printf("score: mean %.1f, best %d (seed %llu)\n", static_cast<double>(stats.scoreTotal) / stats.games,
+                stats.bestScore, static_cast<unsigned long long>(stats.bestSeed));
+
+    static const char* outcomeNames[OUTCOME_COUNT] = { "none", "wall", "boundary", "self", "board full", "timeout" };
+    std::printf("outcomes:");
+    for (int i = DEATH_WALL; i < OUTCOME_COUNT; i++) {
+        std::printf("  %s %lld (%.1f%%)", outcomeNames[i], stats.outcomes[i], 100.0 * stats.outcomes[i] / stats.games);
+    }
+    std::printf("\n");
+
+    std::printf("levels:");
+    for (int level = 1; level <= MAX_LEVEL_BUCKET; level++) {
+        if (stats.levels[level] == 0) continue;
+        std::printf("  %d%s: %lld", level, level == MAX_LEVEL_BUCKET ? "+" : "", stats.levels[level]);
+    }
+    std::printf("\nscores:\n");
+    long long peak = *std::max_element(stats.scoreBuckets.begin(), stats.scoreBuckets.end());
+    for (size_t i = 0; i < stats.scoreBuckets.size(); i++) {
+        if (stats.scoreBuckets[i] == 0) continue;
+        int bar = static_cast<int>(40 * stats.scoreBuckets[i] / peak);
+        std::printf("  %5zu-%-5zu %8lld %s\n", i * SCORE_BUCKET, (i + 1) * SCORE_BUCKET - 1, stats.scoreBuckets[i],
+                    std::string(std::max(bar, 1), '#').c_str());
+    }
+    (void)options;
+}
+
+bool parseStyle(const std::string& name, LevelStyle& style) {
+    for (int i = 0; i < LEVEL_STYLE_COUNT; i++) {
+        if (name == LevelGenerator::styleName(static_cast<LevelStyle>(i))) {
+            style = static_cast<LevelStyle>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--games" && hasValue) {
+            options.games = std::atoll(argv[++i]);
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (arg == "--policy" && hasValue) {
+            std::string name = argv[++i];
+            if (name == "greedy") options.policy = POLICY_GREEDY;
+            else if (name == "hamiltonian") options.policy = POLICY_HAMILTONIAN;
+            else if (name == "mcts") options.policy = POLICY_MCTS;
+            else return false;
+        } else if (arg == "--grid" && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2) return false;
+        } else if (arg == "--style" && hasValue) {
+            if (!parseStyle(argv[++i], options.style)) return false;
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--max-ticks" && hasValue) {
+            options.maxTicks = std::atoll(argv[++i]);
+        } else if (arg == "--budget" && hasValue) {
+            options.budgetMillis = std::atof(argv[++i]);
+        } else if (arg == "--scaling") {
+            options.scaling = true;
+        } else {
+            return false;
+        }
+    }
+    return options.games > 0 && options.maxTicks > 0 && options.width >= 8 && options.height >= 8;
+}
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cout << "Usage: snake_tournament [--games N] [--threads N] [--policy greedy|hamiltonian|mcts]\n"
+                  << "                        [--grid WxH] [--style random|maze|rooms|symmetric] [--seed S]\n"
+                  << "                        [--max-ticks T] [--budget ms] [--scaling]" << std::endl;
+        return 1;
+    }
+    int maxThreads = options.threads > 0 ? options.threads
+                                         : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    if (!options.scaling) {
+        printReport(options, runTournament(options, maxThreads), maxThreads);
+        return 0;
+    }
+
+    // Same games at 1, 2, 4 .. N threads; efficiency is speedup / threads
+    std::vector<int> counts;
+    for (int threads = 1; threads < maxThreads; threads *= 2) counts.push_back(threads);
+    counts.push_back(maxThreads);
+    double baseline = 0;
+    RunResult first, last;
+    std::printf("threads  games/s  speedup  efficiency\n");
+    for (int threads : counts) {
+        last = runTournament(options, threads);
+        double rate = last.totals.games / last.seconds;
+        if (threads == 1) {
+            baseline = rate;
+            first = last;
+        }
+        std::printf("%7d  %7.0f  %7.2f  %9.0f%%\n", threads, rate, rate / baseline, 100.0 * rate / baseline / threads);
+    }
+    std::printf("\n");
+    printReport(options, last, counts.back());
+
+    // Every run played the same seeds, so the merged totals must agree
+    if (options.policy != POLICY_MCTS &&
+        (last.totals.scoreTotal != first.totals.scoreTotal || last.totals.ticks != first.totals.ticks)) {
+        std::cerr << "Results differ between thread counts" << std::endl;
+        return 1;
+    }
+    return 0;
+}
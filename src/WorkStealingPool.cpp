@@ -0,0 +1,121 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(int threadsWanted) :
+    threadCount(threadsWanted > 0 ? threadsWanted : std::max(1, static_cast<int>(std::thread::hardware_concurrency()))),
+    body(nullptr),
+    generation(0),
+    activeThreads(0),
+    stopping(false),
+    chunksLeft(0) {
+    for (int i = 0; i < threadCount; i++) {
+        workers.emplace_back(new Worker());
+    }
+    for (int i = 1; i < threadCount; i++) {
+        threads.emplace_back(&WorkStealingPool::threadLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+bool WorkStealingPool::takeChunk(int worker, Range& range) {
+    {
+        // Own deque: newest first, while its cache lines are still warm
+        Worker& own = *workers[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.chunks.empty()) {
+            range = own.chunks.back();
+            own.chunks.pop_back();
+            return true;
+        }
+    }
+    // Steal the oldest chunk of the next worker round that has one
+    for (int offset = 1; offset < threadCount; offset++) {
+        Worker& victim = *workers[(worker + offset) % threadCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.chunks.empty()) {
+            range = victim.chunks.front();
+            victim.chunks.pop_front();
+            workers[worker]->steals++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::work(int worker) {
+    // No new chunks appear during a job, so once every deque is empty this
+    // worker is done; others may still be finishing their last chunk
+    Range range;
+    while (chunksLeft.load(std::memory_order_acquire) > 0 && takeChunk(worker, range)) {
+        for (long long i = range.begin; i < range.end; i++) {
+            (*body)(i, worker);
+        }
+        chunksLeft.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+void WorkStealingPool::threadLoop(int worker) {
+    unsigned long long seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobReady.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        work(worker);
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            activeThreads--;
+        }
+        jobDone.notify_one();
+    }
+}
+
+void WorkStealingPool::parallelFor(long long count, long long grain, const Body& job) {
+    if (count <= 0) return;
+    grain = std::max(1LL, grain);
+    long long chunks = (count + grain - 1) / grain;
+
+    // Deal contiguous runs of chunks to the workers
+    for (int w = 0; w < threadCount; w++) {
+        long long first = chunks * w / threadCount;
+        long long last = chunks * (w + 1) / threadCount;
+        std::lock_guard<std::mutex> lock(workers[w]->mutex);
+        for (long long c = first; c < last; c++) {
+            workers[w]->chunks.push_back(Range{ c * grain, std::min(count, (c + 1) * grain) });
+        }
+    }
+    chunksLeft.store(chunks, std::memory_order_release);
+
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        body = &job;
+        activeThreads = threadCount - 1;
+        generation++;
+    }
+    jobReady.notify_all();
+
+    work(0);
+    std::unique_lock<std::mutex> lock(jobMutex);
+    jobDone.wait(lock, [this] { return activeThreads == 0; });
+    body = nullptr;
+}
+
+unsigned long long WorkStealingPool::getStealCount() const {
+    unsigned long long total = 0;
+    for (const auto& worker : workers) {
+        total += worker->steals;
+    }
+    return total;
+}
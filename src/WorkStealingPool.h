@@ -0,0 +1,71 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops. parallelFor() cuts the
+// index range into chunks and deals them out to per-worker deques up front;
+// each worker takes chunks from the back of its own deque and, once that is
+// empty, steals from the front of another's. Work of very uneven size (whole
+// games that last 10 or 100000 ticks) therefore balances itself, and the
+// deques are only contended while stealing.
+//
+// The calling thread takes part as worker 0, so a pool of N threads starts
+// N - 1 of its own.
+class WorkStealingPool {
+public:
+    // body(index, worker): worker is in [0, getThreadCount()) and no two
+    // calls with the same worker run at once, so it can index per-worker state
+    typedef std::function<void(long long, int)> Body;
+
+private:
+    struct Range {
+        long long begin, end;
+    };
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Range> chunks;
+        unsigned long long steals = 0;
+    };
+
+    int threadCount;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    // Current job
+    std::mutex jobMutex;
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+    const Body* body;
+    unsigned long long generation;      // Bumped per job; threads wait for a change
+    int activeThreads;                  // Pool threads still working on the job
+    bool stopping;
+    std::atomic<long long> chunksLeft;
+
+    bool takeChunk(int worker, Range& range);
+    void work(int worker);
+    void threadLoop(int worker);
+
+public:
+    // threadsWanted <= 0 uses every hardware thread
+    explicit WorkStealingPool(int threadsWanted = 0);
+    ~WorkStealingPool();
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    int getThreadCount() const { return threadCount; }
+    // Runs body for every index in [0, count), in chunks of `grain`, and
+    // returns when all have finished
+    void parallelFor(long long count, long long grain, const Body& body);
+    // Chunks taken from another worker's deque, over the pool's lifetime
+    unsigned long long getStealCount() const;
+};
+
+#endif
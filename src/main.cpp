@@ -2,13 +2,32 @@
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <cstdio>
+#include <string>
+#include <filesystem>
 
-int main() {
+int main(int argc, char** argv) {
     std::cout << "Starting Snake Game..." << std::endl;
+
+    // Optional board size: SnakeGame --grid 2000x1500
+    int gridWidth = Game::DEFAULT_GRID_WIDTH;
+    int gridHeight = Game::DEFAULT_GRID_HEIGHT;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::string(argv[i]) == "--grid") {
+            if (std::sscanf(argv[i + 1], "%dx%d", &gridWidth, &gridHeight) != 2 ||
+                gridWidth < 10 || gridHeight < 10 ||
+                gridWidth > Game::MAX_GRID_SIZE || gridHeight > Game::MAX_GRID_SIZE) {
+                std::cerr << "Grid must be WxH with sides from 10 to " << Game::MAX_GRID_SIZE << std::endl;
+                return -1;
+            }
+        }
+    }
     
     try {
-        std::cout << "Creating Game object..." << std::endl;
-        Game game;
+        std::cout << "Creating Game object (" << gridWidth << "x" << gridHeight << " board)..." << std::endl;
+        // Assets are found relative to the executable, not the working directory
+        std::string dataDirectory = std::filesystem::path(argv[0]).parent_path().string();
+        Game game(gridWidth, gridHeight, dataDirectory.empty() ? "." : dataDirectory);
         
         std::cout << "Calling game.run()..." << std::endl;
         game.run();